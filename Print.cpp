@@ -23,288 +23,393 @@
 #include "Print.h"
 
 
-size_t Print::write(const uint8_t *buffer, size_t size)
+// Flash is copied to the sink a chunk at a time from the stack; the
+// sink call per character is what made byte-at-a-time printing slow.
+#define CONSTANT_CHUNK 16
+
+// Copies up to n bytes from flash at *src to dst, stopping at a zero,
+// and returns the number copied.  An lpm Z+ loop, 10 cycles a byte.
+static uint8_t constantChunk(uint8_t *dst, PGM_P *src, uint8_t n)
 {
-  size_t n = 0;
-  while (size--) {
-    n += write(*buffer++);
-  }
-  return n;
+  PGM_P z = *src;
+  uint8_t *x = dst;
+  uint8_t c;
+#if defined(__AVR__)
+  asm volatile (
+    "1: lpm %[c], Z+"       "\n\t"
+    "tst %[c]"              "\n\t"
+    "breq 2f"               "\n\t"
+    "st X+, %[c]"           "\n\t"
+    "dec %[n]"              "\n\t"
+    "brne 1b"               "\n\t"
+    "2:"
+    : [c] "=&r" (c), [n] "+r" (n), "+z" (z), "+x" (x)
+    :: "memory"
+  );
+#else
+  // the same loop in C, for host builds
+  while (n-- && (c = pgm_read_byte(z++))) *x++ = c;
+#endif
+  *src = z;
+  return x - dst;
 }
 
-
-// Base method (character)
-size_t Print::print(char c)
+size_t Print::printConstant(const __ConstantStringHelper *cs)
 {
-  return write(c);
+  PGM_P p = reinterpret_cast<PGM_P>(cs);
+  uint8_t buf[CONSTANT_CHUNK];
+  size_t n = 0;
+  uint8_t len;
+  do {
+    len = constantChunk(buf, &p, sizeof(buf));
+    if (len) n += write(buf, len);
+  } while (len == sizeof(buf));
+  return n;
 }
 
-// Base method (string)
-size_t Print::print(const char c[])
+size_t Print::write(const __ConstantStringHelper *str, size_t size)
 {
-  return write(c);
+  PGM_P p = reinterpret_cast<PGM_P>(str);
+  uint8_t buf[CONSTANT_CHUNK];
+  size_t n = 0;
+  while (size)
+  {
+    uint8_t len = size < sizeof(buf) ? size : sizeof(buf);
+    memcpy_P(buf, p, len);
+    n += write(buf, len);
+    p += len;
+    size -= len;
+  }
+  return n;
 }
 
 
-// Base method (unsigned)
-size_t Print::print(unsigned long n, int base)
-{
-  if (base == 0) return write(n);
-  else return printNumber(n, base);
-}
+// private methods
+
+// An AVR has no divide instruction, so a 32-bit n /= base costs
+// several hundred cycles per digit.  Decimal digits are found by
+// subtracting powers of ten, and bases 2, 8 and 16 by shifting;
+// only other bases fall back to division.
 
-// Base method (signed)
-size_t Print::print(long n, int base)
+static const char digitChars[] PROGMEM = "0123456789ABCDEF";
+
+static const uint32_t pow10_32[] PROGMEM = {
+  1000000000, 100000000, 10000000, 1000000, 100000, 10000
+};
+static const uint16_t pow10_16[] PROGMEM = { 10000, 1000, 100, 10 };
+
+// One digit per power of ten from pw to the end of pow10_16, zeros
+// included, then the units.  Returns the end of the digits.
+static char *decimal16(char *str, uint16_t n, const uint16_t *pw)
 {
-  if (base == 0)
+  for (; pw < pow10_16 + 4; pw++)
   {
-    return write(n);
+    uint16_t p = pgm_read_word(pw);
+    char c = '0';
+    while (n >= p) { n -= p; c++; }
+    *str++ = c;
   }
-  else if (base == 10)
+  *str++ = '0' + n;
+  return str;
+}
+
+static char *decimal8(char *str, uint8_t n)
+{
+  char c;
+  bool hundreds = n >= 100;
+  if (hundreds)
   {
-    // why must this only be in base 10?
-    if (n < 0)
-    {
-      int t = print('-');
-      n = -n;
-      return printNumber(n, 10) + t;
-    }
-    return printNumber(n, 10);
+    c = '0';
+    do { n -= 100; c++; } while (n >= 100);
+    *str++ = c;
   }
-  else
+  if (hundreds || n >= 10)
   {
-    return printNumber(n, base);
+    c = '0';
+    while (n >= 10) { n -= 10; c++; }
+    *str++ = c;
   }
+  *str++ = '0' + n;
+  return str;
 }
 
-
-// Overload (unsigned)
-size_t Print::print(unsigned int n, int base)
+static char *decimalShort(char *str, uint16_t n)
 {
-  return print((unsigned long)n, base);
+  if (n < 0x100) return decimal8(str, n);
+
+  const uint16_t *pw = pow10_16;
+  while (n < pgm_read_word(pw)) pw++;
+  return decimal16(str, n, pw);
 }
 
-// Overload (unsigned)
-size_t Print::print(unsigned char n, int base)
+char *_decimal(char *str, uint32_t n)
 {
-  return print((unsigned long) n, base);
+  if (n < 0x10000) return decimalShort(str, n);
+
+  // at least 65536, so the leading digit is at 10^4 or above; after
+  // the 10^4 digit the rest fits in 16 bits
+  const uint32_t *pw = pow10_32;
+  while (n < pgm_read_dword(pw)) pw++;
+  for (; pw < pow10_32 + 6; pw++)
+  {
+    uint32_t p = pgm_read_dword(pw);
+    char c = '0';
+    while (n >= p) { n -= p; c++; }
+    *str++ = c;
+  }
+  return decimal16(str, n, pow10_16 + 1);
 }
 
-// Overload (signed)
-size_t Print::print(int n, int base)
+// Bases 2, 8 and 16, least significant digit first, ending at end.
+template <class T>
+static char *shiftDigits(char *end, T n, uint8_t shift)
 {
-  return print((long)n, base);
+  uint8_t mask = (1 << shift) - 1;
+  do {
+    *--end = pgm_read_byte(digitChars + (n & mask));
+    n >>= shift;
+  } while (n);
+  return end;
 }
 
-
-size_t Print::print(double n, int digits)
+// Formatters for print(n) of integers up to 16 bits, so they don't
+// link the 32-bit tables, and of long integers.
+size_t Print::printDecimal(uint16_t n, bool negative)
 {
-  return printFloat(n, digits);
+  char buf[6];
+  char *str = buf;
+  if (negative) *str++ = '-';
+  return write(buf, decimalShort(str, n) - buf);
 }
 
+size_t Print::printDecimal(uint32_t n, bool negative)
+{
+  char buf[11];
+  char *str = buf;
+  if (negative) *str++ = '-';
+  return write(buf, _decimal(str, n) - buf);
+}
 
-size_t Print::print(const Printable &p)
+// Only decimal shows a sign; other bases print the two's complement.
+size_t Print::printSigned(long n, uint8_t base)
 {
-  return p.printTo(*this);
+  if (base == 10 && n < 0) return printDecimal(0 - (uint32_t)n, true);
+  return printNumber(n, base);
 }
 
-size_t Print::print(const __ConstantStringHelper *cs)
+size_t Print::printNumber(unsigned long n, uint8_t base)
 {
-  //const char PROGMEM *p = (const char PROGMEM *)(cs);
-  PGM_P p = reinterpret_cast<PGM_P>(cs);
-  size_t n = 0;
-  while (1)
+  char buf[8 * sizeof(long)]; // Assumes 8-bit chars.
+  char *end = &buf[sizeof(buf)];
+  char *str;
+
+  // prevent crash if called with base == 1
+  if (base < 2) base = 10;
+
+  if (base == 10)
   {
-    unsigned char c = pgm_read_byte(p++);
-    if (c == 0) break;
-    n += write(c);
+    end = _decimal(buf, n);
+    str = buf;
+  }
+  else if (base == 16 || base == 8 || base == 2)
+  {
+    uint8_t shift = base == 16 ? 4 : base == 8 ? 3 : 1;
+    if (n < 0x10000)
+      str = shiftDigits<uint16_t>(end, n, shift);
+    else
+      str = shiftDigits<uint32_t>(end, n, shift);
+  }
+  else
+  {
+    str = end;
+    do {
+      unsigned long m = n;
+      n /= base;
+      char c = m - base * n;
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
   }
-  return n;
-}
 
+  return write(str, end - str);
+}
 
-size_t Print::print(const String &s)
+// "[-]int[.frac]": frac is the fraction times 10^digits, rounded, and
+// is zero padded to digits places.
+static uint8_t formatDecimal(char *buf, bool negative, uint32_t intPart,
+                             uint32_t frac, uint8_t digits)
 {
-  return write(s.c_str(), s.length());
-}
+  char *str = buf;
+  if (negative && (intPart || frac)) *str++ = '-';
+  str = _decimal(str, intPart);
 
+  if (digits)
+  {
+    *str++ = '.';
+    char tmp[10];
+    uint8_t n = _decimal(tmp, frac) - tmp;
+    for (; n < digits; digits--) *str++ = '0';
+    memcpy(str, tmp, n);
+    str += n;
+  }
 
-size_t Print::println(void)
-{
-  size_t n = print('\r');
-  n += print('\n');
-  return n;
+  *str = '\0';
+  return str - buf;
 }
 
-
-size_t Print::println(const String &s)
+// The binary fraction is scaled to decimal a digit at a time: each
+// step multiplies at most 28 bits by 10, so 32 bits are enough for
+// Fixed8_8 and Fixed16_16 at any number of places.
+uint8_t _fixedFormat(char *buf, uint32_t magnitude, bool negative,
+                     uint8_t fracBits, uint8_t digits)
 {
-  size_t n = print(s);
-  n += println();
-  return n;
-}
+  if (digits > 9) digits = 9;
 
+  uint32_t intPart = magnitude >> fracBits;
+  uint32_t mask = ((uint32_t)1 << fracBits) - 1;
+  uint32_t frac = magnitude & mask;
 
-size_t Print::println(char c)
-{
-  size_t n = print(c);
-  n += println();
-  return n;
+  uint32_t decimals = 0;
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < digits; i++)
+  {
+    frac *= 10;
+    decimals = decimals * 10 + (frac >> fracBits);
+    frac &= mask;
+    scale *= 10;
+  }
+
+  // round half up on what is left below the last place
+  if (fracBits && (frac >> (fracBits - 1)) && ++decimals == scale)
+  {
+    decimals = 0;
+    intPart++;
+  }
+
+  return formatDecimal(buf, negative, intPart, decimals, digits);
 }
 
-size_t Print::println(const char c[])
+uint8_t _fixedFormatWide(char *buf, uint32_t magnitude, bool negative,
+                         uint8_t fracBits, uint8_t digits)
 {
-  size_t n = print(c);
-  n += println();
-  return n;
-}
+  if (digits > 9) digits = 9;
 
+  uint32_t intPart = magnitude >> fracBits;
+  uint32_t frac = magnitude - (intPart << fracBits);
 
-size_t Print::println(unsigned long num, int base)
-{
-  size_t n = print(num, base);
-  n += println();
-  return n;
-}
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < digits; i++) scale *= 10;
 
-size_t Print::println(unsigned int num, int base)
-{
-  size_t n = print(num, base);
-  n += println();
-  return n;
-}
+  if (fracBits)
+  {
+    // scale the binary fraction to decimal, rounded, without a divide;
+    // frac * 10^9 needs up to 61 bits
+    frac = (((uint64_t)frac * scale >> (fracBits - 1)) + 1) >> 1;
+    if (frac >= scale)
+    {
+      frac -= scale;
+      intPart++;
+    }
+  }
 
-size_t Print::println(unsigned char b, int base)
-{
-  size_t n = print(b, base);
-  n += println();
-  return n;
+  return formatDecimal(buf, negative, intPart, frac, digits);
 }
 
-size_t Print::println(long num, int base)
+// Only the fraction is scaled by floating point; the digits themselves
+// come from the integer converter.
+uint8_t _floatFormat(char *buf, double number, uint8_t digits)
 {
-  size_t n = print(num, base);
-  n += println();
-  return n;
-}
+  const char *special = 0;
+  if (isnan(number)) special = "nan";
+  else if (isinf(number)) special = "inf";
+  else if (number > 4294967040.0) special = "ovf";  // constant determined empirically
+  else if (number <-4294967040.0) special = "ovf";  // constant determined empirically
+  if (special)
+  {
+    strcpy(buf, special);
+    return 3;
+  }
 
-size_t Print::println(int num, int base)
-{
-  size_t n = print(num, base);
-  n += println();
-  return n;
-}
+  if (digits > 9) digits = 9;
 
-size_t Print::println(double num, int digits)
-{
-  size_t n = print(num, digits);
-  n += println();
-  return n;
-}
+  bool negative = number < 0.0;
+  if (negative) number = -number;
 
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < digits; i++) scale *= 10;
 
-size_t Print::println(const Printable &p)
-{
-  size_t n = print(p);
-  n += println();
-  return n;
+  uint32_t intPart = (uint32_t)number;
+  uint32_t frac = (uint32_t)((number - (double)intPart) * scale + 0.5);
+  // Round correctly so that print(1.999, 2) prints as "2.00"
+  if (frac >= scale)
+  {
+    frac -= scale;
+    intPart++;
+  }
+
+  return formatDecimal(buf, negative, intPart, frac, digits);
 }
 
+size_t Print::printFloat(double number, uint8_t digits)
+{
+  char buf[FORMAT_BUFFER_SIZE];
+  return write(buf, _floatFormat(buf, number, digits));
+}
 
-size_t Print::println(const __ConstantStringHelper *cs)
+size_t Print::printFill(char c, uint8_t count)
 {
-  size_t n = print(cs);
-  n += println();
+  size_t n = 0;
+  while (count--) n += write(c);
   return n;
 }
 
-
-// private methods
-
-size_t Print::printNumber(unsigned long n, uint8_t base)
+// str right aligned in width columns, or left aligned with
+// _FORMAT_LEFT.  Zero fill goes between the sign and the digits.
+size_t Print::printPadded(const char *str, uint8_t len, uint8_t width,
+                          uint8_t flags)
 {
-  /* BH: new version to be implemented
-    uint8_t buf[sizeof(char) * sizeof(int32_t)];
-    uint32_t i = 0;
-
-    if (n == 0)
-    {
-      write('0');
-      return;
-    }
+  uint8_t pad = len < width ? width - len : 0;
+  if (flags & _FORMAT_LEFT)
+  {
+    size_t n = write(str, len);
+    return n + printFill(' ', pad);
+  }
 
-    while (n > 0)
+  size_t n = 0;
+  if (flags & _FORMAT_ZERO)
+  {
+    if (*str == '-')
     {
-      buf[i++] = n % base;
-      n /= base;
+      n = write(*str++);
+      len--;
     }
-
-    for (; i > 0; i--)
-      write((buf[i - 1] < 10 ?
-            '0' + buf[i - 1] :
-            'A' + buf[i - 1] - 10));
-  */
-
-  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
-  
-  *str = '\0';
-  
-  // prevent crash if called with base == 1
-  if (base < 2) base = 10;
-  
-  do {
-    unsigned long m = n;
-    n /= base;
-    char c = m - base * n;
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
-  
-  return write(str);
+    n += printFill('0', pad);
+  }
+  else
+    n = printFill(' ', pad);
+  return n + write(str, len);
 }
 
-size_t Print::printFloat(double number, uint8_t digits)
+size_t Print::printPadded(uint32_t magnitude, bool negative, uint8_t base,
+                          uint8_t width, uint8_t flags)
 {
-  size_t n = 0;
-  
-  if (isnan(number)) return print("nan");
-  if (isinf(number)) return print("inf");
-  if (number > 4294967040.0) return print ("ovf");  // constant determined empirically
-  if (number <-4294967040.0) return print ("ovf");  // constant determined empirically
-  
-  // Handle negative numbers
-  if (number < 0.0)
+  char buf[8 * sizeof(uint32_t) + 1];
+  char *str = buf;
+  char *end;
+
+  if (base == 10)
   {
-    n += print('-');
-    number = -number;
-  }
-  
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i=0; i<digits; ++i)
-  rounding /= 10.0;
-  
-  number += rounding;
-  
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  double remainder = number - (double)int_part;
-  n += print(int_part);
-  
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) {
-    n += print(".");
+    if (negative) *str++ = '-';
+    end = _decimal(str, magnitude);
+    str = buf;
   }
-  
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0)
+  else
   {
-    remainder *= 10.0;
-    int toPrint = int(remainder);
-    n += print(toPrint);
-    remainder -= toPrint;
+    uint8_t shift = base == 16 ? 4 : base == 8 ? 3 : 1;
+    end = &buf[sizeof(buf)];
+    if (magnitude < 0x10000)
+      str = shiftDigits<uint16_t>(end, magnitude, shift);
+    else
+      str = shiftDigits<uint32_t>(end, magnitude, shift);
   }
-  
-  return n;
+  return printPadded(str, end - str, width, flags);
 }
-
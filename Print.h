@@ -12,6 +12,18 @@
 || | Wiring Common API
 || #
 ||
+|| @example
+|| | class SpiDisplay : public Print {
+|| |   public:
+|| |     constexpr SpiDisplay() : Print(&sink) {}
+|| |   private:
+|| |     static size_t sink(Print &p, const uint8_t *buffer, size_t size) {
+|| |       for (size_t i = 0; i < size; i++) SPI.transfer(buffer[i]);
+|| |       return size;
+|| |     }
+|| | };
+|| #
+||
 || @license Please see cores/Common/License.txt.
 ||
 */
@@ -28,62 +40,267 @@
 #include "WString.h"
 #include "WConstantTypes.h"
 #include "Printable.h"
+#include "WFixed.h"
+
+template <bool B, class T = void> struct _EnableIf {};
+template <class T> struct _EnableIf<true, T> { typedef T type; };
+
+// The types print() formats as numbers (value), and those that take a
+// base as a second argument (withBase).  A lone char prints as a
+// character, but print(c, base) prints its code.  type is what the
+// value is converted to: an enum prints as its underlying type,
+// promoted as with print(int).
+template <class T> struct _IsEnum { static const bool value = __is_enum(T); };
+
+template <class T, bool = _IsEnum<T>::value> struct _PrintNumber
+{
+  static const bool value = false;
+  static const bool withBase = false;
+  static const bool isFloat = false;
+};
+#define _PRINT_NUMBER(T, NUMBER, FLOAT) \
+  template <> struct _PrintNumber<T, false> \
+  { \
+    typedef T type; \
+    static const bool value = NUMBER; \
+    static const bool withBase = true; \
+    static const bool isFloat = FLOAT; \
+    static const bool isSigned = (T)-1 < (T)0; \
+  }
+_PRINT_NUMBER(char, false, false);
+_PRINT_NUMBER(bool, true, false);
+_PRINT_NUMBER(signed char, true, false);
+_PRINT_NUMBER(unsigned char, true, false);
+_PRINT_NUMBER(short, true, false);
+_PRINT_NUMBER(unsigned short, true, false);
+_PRINT_NUMBER(int, true, false);
+_PRINT_NUMBER(unsigned int, true, false);
+_PRINT_NUMBER(long, true, false);
+_PRINT_NUMBER(unsigned long, true, false);
+_PRINT_NUMBER(float, true, true);
+_PRINT_NUMBER(double, true, true);
+_PRINT_NUMBER(long long, true, false);
+_PRINT_NUMBER(unsigned long long, true, false);
+#undef _PRINT_NUMBER
+
+template <class T> struct _PrintNumber<T, true>
+  : _PrintNumber<decltype(+(__underlying_type(T))0)> {};
+
+// The types a base or number of places can have: any integer but char
+// and bool, which print as a second argument.
+template <class T> struct _PrintBase
+{
+  static const bool value = _PrintNumber<T>::value && !_PrintNumber<T>::isFloat;
+};
+template <> struct _PrintBase<bool> { static const bool value = false; };
+
+// selects the float or integer formatter at compile time, so printing
+// an integer never links the float code
+template <bool FLOAT> struct _PrintFloat {};
+
+// Argument modifiers: print(hex(x)), print(fixed(volts, 3))
+template <class T> struct _PrintRadix { T value; uint8_t base; };
+template <class T> struct _PrintPlaces { const T &value; uint8_t digits; };
+
+template <class T> inline _PrintRadix<T> hex(T n) { return _PrintRadix<T>{n, HEX}; }
+template <class T> inline _PrintRadix<T> oct(T n) { return _PrintRadix<T>{n, OCT}; }
+template <class T> inline _PrintRadix<T> bin(T n) { return _PrintRadix<T>{n, BIN}; }
+template <class T> inline _PrintPlaces<T> fixed(const T &x, uint8_t digits)
+{
+  return _PrintPlaces<T>{x, digits};
+}
+
+template <char... C> struct _Format {};
+template <class L, char... R> struct _FormatText;
 
 class Print
 {
   public:
-    Print() {}
-  
-    size_t write(uint8_t);
+    // All output goes through one sink function, which sends size
+    // bytes from buffer to the output behind p and returns how many it
+    // took.  Formatting hands the sink whole runs of bytes, so a sink
+    // can use a block transfer.  A single function pointer costs 2
+    // bytes of RAM and no vtable; a sink that needs state gets it by
+    // casting p to its own class.
+    typedef size_t (*Sink)(Print &p, const uint8_t *buffer, size_t size);
+
+    constexpr Print(Sink sink) : _sink(sink) {}
+
+    size_t write(uint8_t c) { return _sink(*this, &c, 1); }
     size_t write(const char *str) {
       if (str == NULL) return 0;
       return write((const uint8_t *)str, strlen(str));
     }
 
-    size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const uint8_t *buffer, size_t size) {
+      return _sink(*this, buffer, size);
+    }
 
     size_t write(const char *buffer, size_t size) {
       return write((const uint8_t *)buffer, size);
     }
-  
-    // print
-    size_t print(char);
-    size_t print(const char[]);
-
-    size_t print(unsigned long, int = DEC);
-    size_t print(long, int = DEC);
-
-    size_t print(unsigned int, int = DEC);
-    size_t print(unsigned char, int = DEC);
-    size_t print(int, int = DEC);
-    size_t print(double, int = 2);
-
-    size_t print(const Printable &p);
-    size_t print(const __ConstantStringHelper *cs);
-    size_t print(const String &);
-  
-    // println
-    size_t println(void);
-
-    size_t println(const char[]);
-    size_t println(char);
-
-    size_t println(unsigned char, int = DEC);
-    size_t println(unsigned int, int = DEC);
-    size_t println(unsigned long, int = DEC);
-    size_t println(int, int = DEC);
-    size_t println(long, int = DEC);
-    size_t println(double, int = 2);
-
-    size_t println(const Printable &p);
-    size_t println(const __ConstantStringHelper *cs);
-    size_t println(const String &s);
+
+    // size bytes from flash, handed to the sink in chunks
+    size_t write(const __ConstantStringHelper *str, size_t size);
+
+    // print(a, b, ...) prints each argument in turn; every argument is
+    // one write() of its formatted text.  The formatter is picked at
+    // compile time from the argument type, so a byte or int only links
+    // the 16-bit decimal converter.
+    size_t print() { return 0; }
+
+    template <class T, class... Args>
+    size_t print(const T &first, const Args &... rest)
+    {
+      return printArgs(first, rest...);
+    }
+
+    // Two arguments of (number, integer) keep their old meaning of
+    // (value, base), or (value, decimal places) for float, double and
+    // Fixed, whatever the integer type.  A base of 0 writes the value
+    // as a raw byte.
+    template <class T, class B>
+    typename _EnableIf<_PrintNumber<T>::withBase && _PrintBase<B>::value,
+                       size_t>::type
+    print(T n, B base)
+    {
+      typedef _PrintNumber<T> Number;
+      return printBase((typename Number::type)n, (int)base,
+                       _PrintFloat<Number::isFloat>());
+    }
+
+    template <class T, uint8_t FRAC, class D>
+    typename _EnableIf<_PrintBase<D>::value, size_t>::type
+    print(const Fixed<T, FRAC> &value, D digits)
+    {
+      char buf[FORMAT_BUFFER_SIZE];
+      return write(buf, value.format(buf, digits));
+    }
+
+    // printf(Format("t=%d\r\n"), t): the format is parsed at compile
+    // time into print() calls (WFormat.h)
+    template <char END, char... C, class... Args>
+    size_t printf(_Format<END, C...>, const Args &... args)
+    {
+      static_assert(END == 0, "format longer than FORMAT_MAX_LENGTH");
+      return _FormatText<_Format<>, C...>::print(*this, args...);
+    }
+
+    // as print(), then CR LF in a single write
+    template <class... Args>
+    size_t println(const Args &... args)
+    {
+      size_t n = print(args...);
+      return n + write("\r\n", 2);
+    }
 
   private:
+    friend struct _FormatOut;
+
+    Sink _sink;
+
+    size_t printArgs() { return 0; }
+
+    template <class T, class... Args>
+    size_t printArgs(const T &first, const Args &... rest)
+    {
+      size_t n = printArg(first);
+      return n + printArgs(rest...);
+    }
+
+    // char only; other integers must not convert to it
+    template <class T>
+    typename _EnableIf<_PrintNumber<T>::withBase && !_PrintNumber<T>::value,
+                       size_t>::type
+    printArg(T c) { return write(c); }
+    size_t printArg(const char *str) { return write(str); }
+    size_t printArg(const String &s) { return write(s.c_str(), s.length()); }
+    size_t printArg(const Printable &p) { return p.printTo(*this); }
+    size_t printArg(const __ConstantStringHelper *cs) { return printConstant(cs); }
+
+    // a + b + c is written a part at a time rather than made a String
+    template <class L, class R>
+    size_t printArg(const _StringCat<L, R> &sum)
+    {
+      size_t n = printArg(sum.left);
+      return n + printArg(sum.right);
+    }
+    size_t printArg(const _StringRef &s) { return s.len ? write(s.str, s.len) : 0; }
+    size_t printArg(const _StringChar &c) { return write(c.c); }
+    size_t printArg(const _StringDecimal &d)
+    {
+      return printDecimal(d.magnitude, d.negative);
+    }
+    size_t printArg(const _StringReal &r) { return write(r.buf, r.len); }
+
+    template <class T>
+    typename _EnableIf<_PrintNumber<T>::value, size_t>::type
+    printArg(T n)
+    {
+      typedef _PrintNumber<T> Number;
+      return printValue((typename Number::type)n,
+                        _PrintFloat<Number::isFloat>());
+    }
+
+    template <class T>
+    size_t printValue(T n, _PrintFloat<true>) { return printFloat(n, 2); }
+
+    template <class T>
+    size_t printValue(T n, _PrintFloat<false>)
+    {
+      static_assert(sizeof(T) <= sizeof(long),
+                    "print() formats integers of up to 32 bits");
+      bool negative = _PrintNumber<T>::isSigned && n < 0;
+      if (sizeof(T) <= 2)
+      {
+        uint16_t u = n;
+        return printDecimal(negative ? (uint16_t)(0 - u) : u, negative);
+      }
+      uint32_t u = n;
+      return printDecimal(negative ? 0 - u : u, negative);
+    }
+
+    template <class T>
+    size_t printBase(T n, int base, _PrintFloat<true>)
+    {
+      return printFloat(n, base);
+    }
+
+    template <class T>
+    size_t printBase(T n, int base, _PrintFloat<false>)
+    {
+      static_assert(sizeof(T) <= sizeof(long),
+                    "print() formats integers of up to 32 bits");
+      if (base == 0) return write((uint8_t)n);
+      if (_PrintNumber<T>::isSigned) return printSigned(n, base);
+      return printNumber(n, base);
+    }
+
+    template <class T, uint8_t FRAC>
+    size_t printArg(const Fixed<T, FRAC> &value) { return print(value, 2); }
+
+    template <class T>
+    size_t printArg(const _PrintRadix<T> &r) { return print(r.value, r.base); }
+
+    template <class T>
+    size_t printArg(const _PrintPlaces<T> &p) { return print(p.value, p.digits); }
+
+    size_t printDecimal(uint16_t, bool negative);
+    size_t printDecimal(uint32_t, bool negative);
+    size_t printSigned(long, uint8_t);
     size_t printNumber(unsigned long, uint8_t);
     size_t printFloat(double, uint8_t);
+    size_t printConstant(const __ConstantStringHelper *cs);
+
+    // printf field widths
+    size_t printFill(char c, uint8_t count);
+    size_t printPadded(const char *str, uint8_t len, uint8_t width, uint8_t flags);
+    size_t printPadded(uint32_t magnitude, bool negative, uint8_t base,
+                       uint8_t width, uint8_t flags);
 };
 
+#include "WFormat.h"
+
 #endif  // __cplusplus
 #endif
 // PRINT_H
@@ -0,0 +1,35 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Print into a fixed-size RAM buffer.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <string.h>
+#include "PrintBuffer.h"
+
+
+size_t PrintBufferBase::_sink(Print &p, const uint8_t *buffer, size_t size)
+{
+  PrintBufferBase &pb = static_cast<PrintBufferBase &>(p);
+
+  size_t room = pb._capacity - pb._length;
+  if (size > room)
+  {
+    size = room;
+    pb._truncated = true;
+  }
+
+  memcpy(pb._buffer + pb._length, buffer, size);
+  pb._length += size;
+  pb._buffer[pb._length] = '\0';
+  return size;
+}
@@ -0,0 +1,85 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Print into a fixed-size RAM buffer.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @notes
+|| | PrintBuffer<N> holds up to N characters plus a terminating zero, in
+|| | the object itself, so formatting never touches the heap.  Output
+|| | that doesn't fit is dropped and truncated() reports it.  The code
+|| | is in the non-template PrintBufferBase, shared by every size.
+|| #
+||
+|| @example
+|| | PrintBuffer<32> msg;
+|| | msg.print(Constant("T="));
+|| | msg.print(temperature, 1);
+|| | if (!msg.truncated()) Serial.write(msg.c_str(), msg.length());
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef PRINTBUFFER_H
+#define PRINTBUFFER_H
+
+#include <stdint.h>
+#include <Print.h>
+
+class PrintBufferBase : public Print
+{
+  public:
+    const char *c_str() const { return _buffer; }
+    size_t length() const { return _length; }
+    size_t capacity() const { return _capacity; }
+
+    // true once any output has been dropped for lack of room
+    bool truncated() const { return _truncated; }
+
+    void clear()
+    {
+      _length = 0;
+      _truncated = false;
+      _buffer[0] = '\0';
+    }
+
+  protected:
+    PrintBufferBase(char *buffer, size_t capacity)
+      : Print(&_sink), _buffer(buffer), _capacity(capacity)
+    {
+      clear();
+    }
+
+    // the buffer belongs to the derived object
+    PrintBufferBase(const PrintBufferBase &) = delete;
+    PrintBufferBase &operator=(const PrintBufferBase &) = delete;
+
+  private:
+    static size_t _sink(Print &p, const uint8_t *buffer, size_t size);
+
+    char *_buffer;
+    size_t _capacity;
+    size_t _length;
+    bool _truncated;
+};
+
+
+template <size_t N>
+class PrintBuffer : public PrintBufferBase
+{
+  public:
+    PrintBuffer() : PrintBufferBase(_storage, N) {}
+
+  private:
+    char _storage[N + 1];
+};
+
+#endif
+// PRINTBUFFER_H
@@ -21,6 +21,8 @@
 #include "SPI.h"
 
 
+#if defined(SPCR)
+
 void WSPI::begin()
 {
     pinMode(SS, OUTPUT);
@@ -57,3 +59,44 @@ void WSPI::setClockDivider(uint8_t rate) {
 
 
 WSPI SPI;
+
+#elif defined(USIDR)
+
+// USI master, mode 0.  No SS; the sketch drives its own chip select.
+
+void WSPI::begin()
+{
+    pinMode(SCK, OUTPUT);
+    pinMode(MOSI, OUTPUT);
+    pinMode(MISO, INPUT);
+
+    USICR = _BV(USIWM0);
+}
+
+
+void WSPI::end() {
+    USICR = 0;
+    pinMode(SCK, INPUT);
+    pinMode(MOSI, INPUT);
+}
+
+
+// send and receive, clocked by software strobe: 2 USITC writes per bit
+uint8_t WSPI::transfer(uint8_t data)
+{
+  USIDR = data;
+  USISR = _BV(USIOIF);
+  do {
+    USICR = _BV(USIWM0) | _BV(USICS1) | _BV(USICLK) | _BV(USITC);
+  } while (!(USISR & _BV(USIOIF)));
+  return USIDR;
+}
+
+
+// the clock runs as fast as transfer() strobes it
+void WSPI::setClockDivider(uint8_t rate) {}
+
+
+WSPI SPI;
+
+#endif
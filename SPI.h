@@ -44,6 +44,8 @@
 #define SPI_CLOCK_MASK 0x03  // SPR1 = bit 1, SPR0 = bit 0 on SPCR
 #define SPI_2XCLOCK_MASK 0x01  // SPI2X = bit 0 on SPSR
 
+// SPI hardware or the USI (tinyx5) in three-wire mode
+#if defined(SPCR) || defined(USIDR)
 
 class WSPI
 {
@@ -58,14 +60,19 @@ class WSPI
 
 
 inline void WSPI::setBitOrder(uint8_t bitOrder) {
+#if defined(SPCR)
   if(bitOrder == LSBFIRST) {
     SPCR |= _BV(DORD);
   } else {
     SPCR &= ~(_BV(DORD));
   }
+#endif
+  // USI shifts MSB first only
 }
 
 
 extern WSPI SPI;
 
+#endif // SPCR || USIDR
+
 #endif
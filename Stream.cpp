@@ -65,26 +65,52 @@ size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
   return index; // return number of characters, not including null terminator
 }
 
+// Characters are gathered on the stack and appended a chunk at a time.
+#define STREAM_CHUNK 16
+
 String Stream::readString()
 {
   String ret;
-  int c = read();
-  while (c >= 0)
-  {
-    ret += (char)c;
-    c = read();
-  }
+  _readString(-1, ret);
   return ret;
 }
 
 String Stream::readStringUntil(char terminator)
 {
   String ret;
-  int c = read();
-  while (c >= 0 && c != terminator)
+  _readString((uint8_t)terminator, ret);
+  return ret;
+}
+
+unsigned char Stream::readString(String &str)
+{
+  return _readString(-1, str);
+}
+
+unsigned char Stream::readStringUntil(char terminator, String &str)
+{
+  return _readString((uint8_t)terminator, str);
+}
+
+// A terminator of -1 never matches, since read() returns a byte as
+// 0-255.  Input that doesn't fit str is still read up to the
+// terminator, so the next read starts on a fresh line.
+unsigned char Stream::_readString(int terminator, String &str)
+{
+  char buf[STREAM_CHUNK];
+  uint8_t n = 0;
+  unsigned char fits = 1;
+  int c;
+  str = "";
+  while ((c = read()) >= 0 && c != terminator)
   {
-    ret += (char)c;
-    c = read();
+    buf[n++] = c;
+    if (n == sizeof(buf))
+    {
+      if (!str.concat(buf, n)) fits = 0;
+      n = 0;
+    }
   }
-  return ret;
+  if (n && !str.concat(buf, n)) fits = 0;
+  return fits;
 }
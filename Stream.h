@@ -31,14 +31,23 @@ class Stream : public Print
 {
   public:
     //virtual ~Stream() {}
-    int available();
 
-    // no peek to keep things simple
-    //virtual int peek() = 0;
-    int read();
-    void flush() {};
-  
-    Stream() {}
+    // The source answers a request about the stream s: READ returns
+    // the next input byte, or -1 if none is waiting; AVAILABLE returns
+    // the number of bytes waiting; FLUSH waits until all written data
+    // has been sent.  Like the sink, it keeps Stream free of a vtable.
+    // The derived classes shadow read(), write(), available() and
+    // flush() with direct calls, and add peek() if they buffer input.
+    enum SourceRequest { READ, AVAILABLE, FLUSH };
+    typedef int (*Source)(Stream &s, SourceRequest request);
+
+    constexpr Stream(Sink sink, Source source)
+      : Print(sink), _source(source) {}
+
+    int available() { return _source(*this, AVAILABLE); }
+    int read() { return _source(*this, READ); }
+    // waits until all written data has been sent
+    void flush() { _source(*this, FLUSH); }
   
   
     size_t readBytes( char *buffer, size_t length); // read chars from stream into buffer
@@ -52,6 +61,15 @@ class Stream : public Print
     // Wiring String functions to be added here
     String readString();
     String readStringUntil(char terminator);
+    // as above, into str, which may be a StaticString; false if str
+    // couldn't hold it all
+    unsigned char readString(String &str);
+    unsigned char readStringUntil(char terminator, String &str);
+
+  private:
+    Source _source;
+
+    unsigned char _readString(int terminator, String &str);
 };
 
 #endif
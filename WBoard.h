@@ -0,0 +1,95 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Pin to register mapping from a table-driven board description.
+|| |
+|| | Included at the end of each board header, which must first define:
+|| |   TOTAL_PINS, WIRING_PORTS
+|| |   WIRING_PORT_REGS  the PINx register of each port, in port order
+|| |   WIRING_PIN_MAP    WPIN(port, bit) for each digital pin, in pin order
+|| |
+|| | The tables are constexpr, so the mapping macros fold to constants
+|| | for a constant pin on any number of ports.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WBOARD_H
+#define WBOARD_H
+
+#include <avr/io.h>
+
+// port index and bit of a digital pin, packed into one byte
+#define WPIN(PORT, BIT) (((PORT) << 3) | (BIT))
+
+// the 8 pins of PORT in bit order
+#define WPORT_PINS(PORT) \
+        WPIN(PORT, 0), WPIN(PORT, 1), WPIN(PORT, 2), WPIN(PORT, 3), \
+        WPIN(PORT, 4), WPIN(PORT, 5), WPIN(PORT, 6), WPIN(PORT, 7)
+
+// Data space address of each port's PINx.  avr/io.h defines registers
+// as dereferenced pointers, which are not constant expressions, so the
+// register macros are briefly redefined to yield the plain address.
+#pragma push_macro("_SFR_IO8")
+#pragma push_macro("_SFR_MEM8")
+#undef _SFR_IO8
+#undef _SFR_MEM8
+#define _SFR_IO8(io_addr) ((io_addr) + __SFR_OFFSET)
+#define _SFR_MEM8(mem_addr) (mem_addr)
+
+constexpr uint16_t wiringPortTable[WIRING_PORTS] = { WIRING_PORT_REGS };
+
+#pragma pop_macro("_SFR_MEM8")
+#pragma pop_macro("_SFR_IO8")
+
+constexpr uint8_t wiringPinTable[TOTAL_PINS] = { WIRING_PIN_MAP };
+
+
+/*************************************************************
+ * Pin to register mapping macros
+ *************************************************************/
+
+// PINx, DDRx and PORTx are consecutive on every AVR
+#define WIRING_PIN_REG  0
+#define WIRING_DDR_REG  1
+#define WIRING_PORT_REG 2
+
+// data space address of a port register
+#define portRegisterAddr(PORT, REG) (wiringPortTable[PORT] + (REG))
+
+// sbi/cbi reach data space 0x20-0x3F; above that (e.g. PORTH-PORTL
+// on the m2560) a bit write is a non-atomic lds/sts sequence
+#define portBitAddressable(PORT) \
+        (portRegisterAddr(PORT, WIRING_PORT_REG) < 0x40)
+
+#define portInputRegister(PORT) \
+        ( ((PORT) < WIRING_PORTS) ? \
+          &_SFR_MEM8(portRegisterAddr(PORT, WIRING_PIN_REG)) : NOT_A_REG)
+
+#define portModeRegister(PORT) \
+        ( ((PORT) < WIRING_PORTS) ? \
+          &_SFR_MEM8(portRegisterAddr(PORT, WIRING_DDR_REG)) : NOT_A_REG)
+
+#define portOutputRegister(PORT) \
+        ( ((PORT) < WIRING_PORTS) ? \
+          &_SFR_MEM8(portRegisterAddr(PORT, WIRING_PORT_REG)) : NOT_A_REG)
+
+#define digitalPinToPort(PIN) \
+        ( ((PIN) < TOTAL_PINS) ? (wiringPinTable[PIN] >> 3) : NOT_A_PORT)
+
+#define digitalPinToBit(PIN) \
+        ( ((PIN) < TOTAL_PINS) ? (wiringPinTable[PIN] & 7) : 0)
+
+#define digitalPinToBitMask(PIN) (1 << (digitalPinToBit(PIN)))
+
+#define digitalPinToPortReg(PIN) portOutputRegister(digitalPinToPort(PIN))
+
+#endif
+// WBOARD_H
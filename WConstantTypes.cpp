@@ -49,7 +49,7 @@ void ConstantString::printTo(Print &stream) const
 
 size_t ConstantString::printTo(Print &stream) const
 {
-  stream.print((const __ConstantStringHelper *)(arr));
+  return stream.write(*this, length());
 }
 
 
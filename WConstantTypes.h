@@ -39,36 +39,44 @@ class ConstantString : public Printable
 {
   private:
     const char PROGMEM *arr;
+    mutable size_t len;  // (size_t)-1 until length() first scans it
 
   public:
   ConstantString(const __ConstantStringHelper *p) :
-  
-  arr(reinterpret_cast<const char PROGMEM *>(const_cast<__ConstantStringHelper *>(p)))
+  arr(reinterpret_cast<const char PROGMEM *>(p)), len((size_t)-1)
   {
   }
-  
+
+  // the ConstantString() macro passes the length it knows at compile time
+  ConstantString(const __ConstantStringHelper *p, size_t length) :
+  arr(reinterpret_cast<const char PROGMEM *>(p)), len(length)
+  {
+  }
+
   size_t length() const
   {
-    return strlen_P(arr);
+    if (len == (size_t)-1) len = strlen_P(arr);
+    return len;
   }
   
   char operator[](int index) const;
   
   operator const __ConstantStringHelper *() const
   {
-    return reinterpret_cast<const __ConstantStringHelper *>(const_cast<char PROGMEM *>(arr));
+    return reinterpret_cast<const __ConstantStringHelper *>(arr);
   }
   
   size_t printTo(Print &stream) const;
 };
 
 /* For inline/auto creation of ConstantStrings */
-#define Constant(str) reinterpret_cast<__ConstantStringHelper *>(PSTR(str))
+#define Constant(str) reinterpret_cast<const __ConstantStringHelper *>(PSTR(str))
 
 /* For global/static creation of ConstantStrings */
 #define ConstantString(name, value) \
-  static char __##name[] PROGMEM = value; \
-  ConstantString name = reinterpret_cast<__ConstantStringHelper *>(__##name);
+  static const char __##name[] PROGMEM = value; \
+  ConstantString name(reinterpret_cast<const __ConstantStringHelper *>(__##name), \
+                      sizeof(__##name) - 1);
 
 /*
   The template class ConstantTable represents a read-only array of an underlying type
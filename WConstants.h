@@ -41,6 +41,8 @@
 #define INPUT    0x0
 #define OUTPUT   0x1
 //#define OUTPUT   0xFF
+#define INPUT_PULLUP      0x2
+#define OUTPUT_OPEN_DRAIN 0x3
 
 #define CHANGE   1
 #define FALLING  2
@@ -0,0 +1,157 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Runtime digital pin/port control for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | Used when the pin number is not a compile-time constant.  The
+|| | pin to port/mask mapping is looked up from flash tables built
+|| | from the board definition, so every call is constant time.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <avr/pgmspace.h>
+#include "Wiring.h"
+
+/*************************************************************
+ * Flash tables
+ *************************************************************/
+
+// index sequence 0..N-1 for expanding the board's constexpr tables
+template <uint8_t... I> struct PinIndex {};
+template <uint8_t N, uint8_t... I>
+struct MakePinIndex : MakePinIndex<N - 1, N - 1, I...> {};
+template <uint8_t... I>
+struct MakePinIndex<0, I...> { typedef PinIndex<I...> type; };
+
+struct PinTable
+{
+  uint8_t port[TOTAL_PINS];
+  uint8_t mask[TOTAL_PINS];
+};
+
+template <uint8_t... I>
+constexpr PinTable makePinTable(PinIndex<I...>)
+{
+  return { { digitalPinToPort(I)... }, { digitalPinToBitMask(I)... } };
+}
+
+static const PinTable pinTable PROGMEM =
+  makePinTable(MakePinIndex<TOTAL_PINS>::type());
+
+// PINx address for each port; DDRx and PORTx follow it in the
+// register file on every AVR, so one table covers all three
+struct PortTable
+{
+  uint16_t pin[WIRING_PORTS];
+};
+
+template <uint8_t... I>
+constexpr PortTable makePortTable(PinIndex<I...>)
+{
+  return { { portRegisterAddr(I, WIRING_PIN_REG)... } };
+}
+
+static const PortTable portTable PROGMEM =
+  makePortTable(MakePinIndex<WIRING_PORTS>::type());
+
+// addressed as avr/io.h addresses registers
+static inline volatile uint8_t *portRegister(uint8_t port, uint8_t reg)
+{
+  return &_SFR_MEM8(pgm_read_word(&portTable.pin[port]) + reg);
+}
+
+static inline volatile uint8_t *pinRegister(uint8_t pin, uint8_t reg)
+{
+  return portRegister(pgm_read_byte(&pinTable.port[pin]), reg);
+}
+
+
+/*************************************************************
+ * Pin functions
+ *************************************************************/
+
+void _pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin >= TOTAL_PINS) return;
+
+  volatile uint8_t *ddr = pinRegister(pin, WIRING_DDR_REG);
+  volatile uint8_t *out = ddr + 1;
+  uint8_t mask = pgm_read_byte(&pinTable.mask[pin]);
+
+  uint8_t sreg = SREG;
+  cli();
+  if (mode == INPUT_PULLUP)
+    *out |= mask;
+  else if (mode == OUTPUT_OPEN_DRAIN)
+    *out &= ~mask;
+
+  if (mode == OUTPUT)
+    *ddr |= mask;
+  else
+    *ddr &= ~mask;
+
+  if (mode == INPUT)
+    *out &= ~mask;
+  SREG = sreg;
+}
+
+
+uint8_t _pinRead(uint8_t pin)
+{
+  if (pin >= TOTAL_PINS) return LOW;
+
+  return (*pinRegister(pin, WIRING_PIN_REG) & pgm_read_byte(&pinTable.mask[pin])) ?
+         HIGH : LOW;
+}
+
+
+void _pinWrite(uint8_t pin, uint8_t value)
+{
+  if (pin >= TOTAL_PINS) return;
+
+  volatile uint8_t *out = pinRegister(pin, WIRING_PORT_REG);
+  uint8_t mask = pgm_read_byte(&pinTable.mask[pin]);
+
+  // an ISR may modify other bits of the same port
+  uint8_t sreg = SREG;
+  cli();
+  if (value)
+    *out |= mask;
+  else
+    *out &= ~mask;
+  SREG = sreg;
+}
+
+
+/*************************************************************
+ * Port functions
+ *************************************************************/
+
+void _portMode(uint8_t port, uint8_t mode)
+{
+  if (port >= WIRING_PORTS) return;
+  *portRegister(port, WIRING_DDR_REG) = mode ? 0xFF : 0x00;
+}
+
+
+uint8_t _portRead(uint8_t port)
+{
+  if (port >= WIRING_PORTS) return 0;
+  return *portRegister(port, WIRING_PIN_REG);
+}
+
+
+void _portWrite(uint8_t port, uint8_t value)
+{
+  if (port >= WIRING_PORTS) return;
+  *portRegister(port, WIRING_PORT_REG) = value;
+}
@@ -0,0 +1,154 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Fixed-point numbers for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @notes
+|| | Fixed<T, FRAC> stores a value as a T holding value * 2^FRAC, so
+|| | Fixed8_8 covers -128..127.996 in steps of 1/256 and Fixed16_16
+|| | covers -32768..32767.99998 in steps of 1/65536.  Addition and
+|| | subtraction are plain integer operations; multiplication and
+|| | division go through the next wider integer type.  Print and String
+|| | format them without any floating point code.
+|| #
+||
+|| @example
+|| | Fixed16_16 volts = Fixed16_16::fromADC(analogRead(A0), 5);
+|| | Fixed16_16 amps = volts / Fixed16_16::fromFloat(0.47);
+|| | Serial.print(amps, 3);
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WFIXED_H
+#define WFIXED_H
+
+#include <stdint.h>
+
+// Buffer size for _fixedFormat and _floatFormat: sign, 10 integer
+// digits, point, 9 decimals and the terminating zero.
+#define FORMAT_BUFFER_SIZE 22
+
+// Integer-only decimal formatting (Print.cpp), shared by Print and
+// String.  All write "[-]int[.frac]" with digits decimals (at most 9)
+// and a terminating zero, and return the length.  _fixedFormat takes
+// up to FIXED_FORMAT_BITS fraction bits with 32-bit arithmetic;
+// _fixedFormatWide takes up to 31 but links a 64-bit multiply.
+#define FIXED_FORMAT_BITS 28
+uint8_t _fixedFormat(char *buf, uint32_t magnitude, bool negative,
+                     uint8_t fracBits, uint8_t digits);
+uint8_t _fixedFormatWide(char *buf, uint32_t magnitude, bool negative,
+                         uint8_t fracBits, uint8_t digits);
+uint8_t _floatFormat(char *buf, double number, uint8_t digits);
+// division-free decimal digits of n at str, unterminated; returns the end
+char *_decimal(char *str, uint32_t n);
+
+// products and quotients are computed one size up
+template <class T> struct _FixedWide;
+template <> struct _FixedWide<int8_t>   { typedef int16_t type; };
+template <> struct _FixedWide<uint8_t>  { typedef uint16_t type; };
+template <> struct _FixedWide<int16_t>  { typedef int32_t type; };
+template <> struct _FixedWide<uint16_t> { typedef uint32_t type; };
+template <> struct _FixedWide<int32_t>  { typedef int64_t type; };
+template <> struct _FixedWide<uint32_t> { typedef uint64_t type; };
+
+template <class T, uint8_t FRAC>
+class Fixed
+{
+    static_assert(FRAC < 8 * sizeof(T) - 1, "Fixed needs an integer bit");
+    typedef typename _FixedWide<T>::type W;
+
+  public:
+    static const T ONE = (T)1 << FRAC;
+
+    constexpr Fixed() : _raw(0) {}
+    constexpr Fixed(int n) : _raw(n * ONE) {}
+    // would truncate to an integer; use fromFloat()
+    Fixed(double) = delete;
+
+    static constexpr Fixed fromRaw(T raw) { return Fixed(raw, true); }
+
+    // For constants only; a runtime argument links the float library.
+    static constexpr Fixed fromFloat(double d)
+    {
+      return fromRaw(d * ONE + (d < 0 ? -0.5 : 0.5));
+    }
+
+    // An ADC reading of 0..2^bits-1 scaled to 0..fullScale, e.g. the
+    // reference voltage.
+    static Fixed fromADC(uint16_t reading, Fixed fullScale, uint8_t bits = 10)
+    {
+      return fromRaw(((W)reading * fullScale._raw) >> bits);
+    }
+
+    constexpr T raw() const { return _raw; }
+
+    // integer part, rounded down or to nearest
+    constexpr T toInt() const { return _raw >> FRAC; }
+    constexpr T round() const { return (_raw + (ONE >> 1)) >> FRAC; }
+
+    // text for Print and String; buf needs FORMAT_BUFFER_SIZE bytes
+    uint8_t format(char *buf, uint8_t digits) const
+    {
+      bool negative = _raw < 0;
+      uint32_t magnitude = negative ? 0 - (uint32_t)_raw : (uint32_t)_raw;
+      if (FRAC <= FIXED_FORMAT_BITS)
+        return _fixedFormat(buf, magnitude, negative, FRAC, digits);
+      return _fixedFormatWide(buf, magnitude, negative, FRAC, digits);
+    }
+
+    constexpr Fixed operator - () const { return fromRaw(-_raw); }
+
+    friend constexpr Fixed operator + (Fixed a, Fixed b) { return fromRaw(a._raw + b._raw); }
+    friend constexpr Fixed operator - (Fixed a, Fixed b) { return fromRaw(a._raw - b._raw); }
+    friend constexpr Fixed operator * (Fixed a, Fixed b)
+    {
+      return fromRaw(((W)a._raw * b._raw) >> FRAC);
+    }
+    friend constexpr Fixed operator / (Fixed a, Fixed b)
+    {
+      return fromRaw((W)a._raw * ONE / b._raw);
+    }
+
+    // scaling by an integer needs no wide arithmetic
+    friend constexpr Fixed operator * (Fixed a, int n) { return fromRaw(a._raw * n); }
+    friend constexpr Fixed operator * (int n, Fixed a) { return fromRaw(a._raw * n); }
+    friend constexpr Fixed operator / (Fixed a, int n) { return fromRaw(a._raw / n); }
+    friend Fixed operator * (Fixed a, double) = delete;
+    friend Fixed operator * (double, Fixed a) = delete;
+    friend Fixed operator / (Fixed a, double) = delete;
+
+    Fixed & operator += (Fixed b) { _raw += b._raw; return *this; }
+    Fixed & operator -= (Fixed b) { _raw -= b._raw; return *this; }
+    Fixed & operator *= (Fixed b) { return *this = *this * b; }
+    Fixed & operator /= (Fixed b) { return *this = *this / b; }
+    Fixed & operator *= (int n) { _raw *= n; return *this; }
+    Fixed & operator /= (int n) { _raw /= n; return *this; }
+
+    friend constexpr bool operator == (Fixed a, Fixed b) { return a._raw == b._raw; }
+    friend constexpr bool operator != (Fixed a, Fixed b) { return a._raw != b._raw; }
+    friend constexpr bool operator < (Fixed a, Fixed b) { return a._raw < b._raw; }
+    friend constexpr bool operator > (Fixed a, Fixed b) { return a._raw > b._raw; }
+    friend constexpr bool operator <= (Fixed a, Fixed b) { return a._raw <= b._raw; }
+    friend constexpr bool operator >= (Fixed a, Fixed b) { return a._raw >= b._raw; }
+
+  private:
+    constexpr Fixed(T raw, bool) : _raw(raw) {}
+
+    T _raw;
+};
+
+typedef Fixed<int16_t, 8> Fixed8_8;
+typedef Fixed<int32_t, 16> Fixed16_16;
+
+#endif
+// WFIXED_H
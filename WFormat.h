@@ -0,0 +1,345 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | printf-style formatting parsed at compile time for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @notes
+|| | The compiler takes the format string apart: each run of literal
+|| | text becomes a flash string, and each conversion a direct call to
+|| | the formatter for its argument's type.  Nothing is parsed at run
+|| | time and vfprintf is never linked.  Identical text runs are shared
+|| | between formats.
+|| |
+|| | Conversions are %d %i %u, %x %X (both upper case), %o, %b (binary),
+|| | %c, %s (anything print() takes), %f (float, double or Fixed; 6
+|| | places unless given as .N) and %%.  The '-' and '0' flags and a
+|| | field width work as in printf.  Length modifiers are accepted and
+|| | ignored, since the argument types are known.  A wrong number of
+|| | arguments, an unknown conversion, or a format longer than
+|| | FORMAT_MAX_LENGTH characters is a compile error.
+|| #
+||
+|| @example
+|| | Serial.printf(Format("%s: %3d.%02u C\r\n"), name, whole, hundredths);
+|| | Serial.printf(Format("reg %02X = %08b\r\n"), addr, value);
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WFORMAT_H
+#define WFORMAT_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#define FORMAT_MAX_LENGTH 64
+
+// Format("...") is a _Format holding the characters of the string,
+// zero padded to FORMAT_MAX_LENGTH, after a first character that is
+// only zero if the string fits.
+template <size_t N>
+constexpr char _formatChar(const char (&str)[N], size_t i)
+{
+  return i < N ? str[i] : 0;
+}
+
+#define _FORMAT_4(s, i) \
+        _formatChar(s, i), _formatChar(s, i + 1), \
+        _formatChar(s, i + 2), _formatChar(s, i + 3)
+#define _FORMAT_16(s, i) \
+        _FORMAT_4(s, i), _FORMAT_4(s, i + 4), \
+        _FORMAT_4(s, i + 8), _FORMAT_4(s, i + 12)
+#define Format(str) \
+        _Format<_formatChar(str, FORMAT_MAX_LENGTH), \
+                _FORMAT_16(str, 0), _FORMAT_16(str, 16), \
+                _FORMAT_16(str, 32), _FORMAT_16(str, 48)>()
+
+template <bool B, class T, class E> struct _FormatIf { typedef T type; };
+template <class T, class E> struct _FormatIf<false, T, E> { typedef E type; };
+
+enum { _FORMAT_LEFT = 1, _FORMAT_ZERO = 2 };
+
+// A run of literal text: one character is written directly, longer
+// runs are printed from flash.
+template <char... L>
+struct _FormatLiteral
+{
+  static const char text[sizeof...(L)] PROGMEM;
+  static size_t print(Print &p)
+  {
+    return p.write(reinterpret_cast<const __ConstantStringHelper *>(text),
+                   sizeof(text));
+  }
+};
+template <char... L>
+const char _FormatLiteral<L...>::text[sizeof...(L)] PROGMEM = { L... };
+
+template <char C>
+struct _FormatLiteral<C>
+{
+  static size_t print(Print &p) { return p.write(C); }
+};
+
+template <>
+struct _FormatLiteral<>
+{
+  static size_t print(Print &) { return 0; }
+};
+
+// counts what print() would write, for right-aligned %s
+class _FormatCount : public Print
+{
+  public:
+    constexpr _FormatCount() : Print(&_sink) {}
+  private:
+    static size_t _sink(Print &, const uint8_t *, size_t size) { return size; }
+};
+
+// The formatter behind each conversion
+struct _FormatOut
+{
+  // a char argument prints its code, an enum its underlying value
+  static int integer(char c) { return c; }
+  template <class T>
+  static typename _PrintNumber<T>::type integer(const T &n)
+  {
+    typedef typename _PrintNumber<T>::type Integer;
+    static_assert(sizeof(Integer) <= sizeof(long),
+                  "format() takes integers of up to 32 bits");
+    return (Integer)n;
+  }
+
+  // as printf, negative values print as unsigned of at least 16 bits
+  template <class T>
+  static typename _FormatIf<(sizeof(T) > 2), uint32_t, uint16_t>::type
+  toUnsigned(const T &n) { return n; }
+
+  template <class T>
+  static size_t decimal(Print &p, const T &n, uint8_t width, uint8_t flags)
+  {
+    if (!width) return p.print(n);
+    bool negative = _PrintNumber<T>::isSigned && n < 0;
+    uint32_t u = n;
+    return p.printPadded(negative ? 0 - u : u, negative, 10, width, flags);
+  }
+
+  template <class T>
+  static size_t radix(Print &p, const T &n, uint8_t base, uint8_t width,
+                      uint8_t flags)
+  {
+    if (!width) return p.printNumber(toUnsigned(n), base);
+    return p.printPadded(toUnsigned(n), false, base, width, flags);
+  }
+
+  static uint8_t real(char *buf, double x, uint8_t digits)
+  {
+    return _floatFormat(buf, x, digits);
+  }
+
+  template <class T, uint8_t FRAC>
+  static uint8_t real(char *buf, const Fixed<T, FRAC> &x, uint8_t digits)
+  {
+    return x.format(buf, digits);
+  }
+
+  template <class T>
+  static size_t text(Print &p, const T &arg, uint8_t width, uint8_t flags)
+  {
+    if (!width) return p.print(arg);
+    _FormatCount count;
+    uint8_t len = count.print(arg);
+    uint8_t pad = len < width ? width - len : 0;
+    if (flags & _FORMAT_LEFT)
+    {
+      size_t n = p.print(arg);
+      return n + p.printFill(' ', pad);
+    }
+    size_t n = p.printFill(' ', pad);
+    return n + p.print(arg);
+  }
+
+  template <class T>
+  static size_t real(Print &p, const T &x, int8_t places, uint8_t width,
+                     uint8_t flags)
+  {
+    char buf[FORMAT_BUFFER_SIZE];
+    uint8_t len = real(buf, x, places < 0 ? 6 : places);
+    return p.printPadded(buf, len, width, flags);
+  }
+};
+
+// Conversion characters by the formatter they use
+enum
+{
+  _FORMAT_INVALID, _FORMAT_SIGNED, _FORMAT_UNSIGNED, _FORMAT_HEX,
+  _FORMAT_OCT, _FORMAT_BIN, _FORMAT_CHAR, _FORMAT_STRING, _FORMAT_REAL
+};
+
+constexpr uint8_t _formatKind(char c)
+{
+  return c == 'd' || c == 'i' ? _FORMAT_SIGNED :
+         c == 'u' ? _FORMAT_UNSIGNED :
+         c == 'x' || c == 'X' ? _FORMAT_HEX :
+         c == 'o' ? _FORMAT_OCT :
+         c == 'b' ? _FORMAT_BIN :
+         c == 'c' ? _FORMAT_CHAR :
+         c == 's' ? _FORMAT_STRING :
+         c == 'f' || c == 'F' ? _FORMAT_REAL : _FORMAT_INVALID;
+}
+
+template <uint8_t KIND, uint8_t FLAGS, uint8_t WIDTH, int8_t PLACES>
+struct _FormatConvert
+{
+  template <class T>
+  static size_t print(Print &, const T &)
+  {
+    static_assert(KIND != _FORMAT_INVALID, "unknown format conversion");
+    return 0;
+  }
+};
+
+#define _FORMAT_CONVERT(KIND, CALL) \
+  template <uint8_t FLAGS, uint8_t WIDTH, int8_t PLACES> \
+  struct _FormatConvert<KIND, FLAGS, WIDTH, PLACES> \
+  { \
+    template <class T> \
+    static size_t print(Print &p, const T &arg) { return CALL; } \
+  }
+_FORMAT_CONVERT(_FORMAT_SIGNED,
+  _FormatOut::decimal(p, _FormatOut::integer(arg), WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_UNSIGNED,
+  _FormatOut::decimal(p, _FormatOut::toUnsigned(_FormatOut::integer(arg)), WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_HEX,
+  _FormatOut::radix(p, _FormatOut::integer(arg), HEX, WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_OCT,
+  _FormatOut::radix(p, _FormatOut::integer(arg), OCT, WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_BIN,
+  _FormatOut::radix(p, _FormatOut::integer(arg), BIN, WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_CHAR,
+  _FormatOut::text(p, (char)_FormatOut::integer(arg), WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_STRING,
+  _FormatOut::text(p, arg, WIDTH, FLAGS));
+_FORMAT_CONVERT(_FORMAT_REAL,
+  _FormatOut::real(p, arg, PLACES, WIDTH, FLAGS));
+#undef _FORMAT_CONVERT
+
+// One conversion, then the text after it
+template <char C, uint8_t FLAGS, uint8_t WIDTH, int8_t PLACES, char... R>
+struct _FormatArg
+{
+  template <class T, class... Args>
+  static size_t print(Print &p, const T &arg, const Args &... rest)
+  {
+    size_t n = _FormatConvert<_formatKind(C), FLAGS, WIDTH, PLACES>::print(p, arg);
+    return n + _FormatText<_Format<>, R...>::print(p, rest...);
+  }
+
+  template <class... Args>
+  static size_t print(Print &, const Args &...)
+  {
+    static_assert(sizeof...(Args) > 0, "too few arguments for format");
+    return 0;
+  }
+};
+
+// The part of a conversion after the '%': flags, width, .places and
+// length modifiers, one character at a time.
+template <uint8_t FLAGS, uint8_t WIDTH, int8_t PLACES, char... R>
+struct _FormatSpec
+{
+  static_assert(sizeof...(R) > 0, "format ends inside a conversion");
+};
+
+template <uint8_t FLAGS, uint8_t WIDTH, int8_t PLACES, char C, char... R>
+struct _FormatSpec<FLAGS, WIDTH, PLACES, C, R...>
+{
+  static const bool digit = C >= '0' && C <= '9';
+  static const bool width = digit && PLACES < 0;
+
+  typedef typename _FormatIf<C == '-',
+    _FormatSpec<FLAGS | _FORMAT_LEFT, WIDTH, PLACES, R...>,
+  typename _FormatIf<C == '0' && !WIDTH && PLACES < 0,
+    _FormatSpec<FLAGS | _FORMAT_ZERO, WIDTH, PLACES, R...>,
+  typename _FormatIf<width,
+    _FormatSpec<FLAGS, (width ? WIDTH * 10 + C - '0' : 0), PLACES, R...>,
+  typename _FormatIf<digit,
+    _FormatSpec<FLAGS, WIDTH, (digit && !width ? PLACES * 10 + C - '0' : 0), R...>,
+  typename _FormatIf<C == '.',
+    _FormatSpec<FLAGS, WIDTH, 0, R...>,
+  typename _FormatIf<C == 'l' || C == 'h' || C == 'L',
+    _FormatSpec<FLAGS, WIDTH, PLACES, R...>,
+    _FormatArg<C, FLAGS, WIDTH, PLACES, R...>
+  >::type>::type>::type>::type>::type>::type Next;
+
+  template <class... Args>
+  static size_t print(Print &p, const Args &... args)
+  {
+    return Next::print(p, args...);
+  }
+};
+
+// Literal text L so far, and the rest R of the format
+template <char... L, char C, char... R>
+struct _FormatText<_Format<L...>, C, R...>
+{
+  template <class... Args>
+  static size_t print(Print &p, const Args &... args)
+  {
+    return _FormatText<_Format<L..., C>, R...>::print(p, args...);
+  }
+};
+
+template <char... L, char... R>
+struct _FormatText<_Format<L...>, '%', '%', R...>
+{
+  template <class... Args>
+  static size_t print(Print &p, const Args &... args)
+  {
+    return _FormatText<_Format<L..., '%'>, R...>::print(p, args...);
+  }
+};
+
+template <char... L, char... R>
+struct _FormatText<_Format<L...>, '%', R...>
+{
+  template <class... Args>
+  static size_t print(Print &p, const Args &... args)
+  {
+    size_t n = _FormatLiteral<L...>::print(p);
+    return n + _FormatSpec<0, 0, -1, R...>::print(p, args...);
+  }
+};
+
+template <char... L, char... R>
+struct _FormatText<_Format<L...>, '\0', R...>
+{
+  template <class... Args>
+  static size_t print(Print &p, const Args &...)
+  {
+    static_assert(sizeof...(Args) == 0, "too many arguments for format");
+    return _FormatLiteral<L...>::print(p);
+  }
+};
+
+template <char... L>
+struct _FormatText<_Format<L...> >
+{
+  template <class... Args>
+  static size_t print(Print &p, const Args &...)
+  {
+    static_assert(sizeof...(Args) == 0, "too many arguments for format");
+    return _FormatLiteral<L...>::print(p);
+  }
+};
+
+#endif
+// WFORMAT_H
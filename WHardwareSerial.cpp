@@ -26,116 +26,45 @@
 */
 
 #include <avr/io.h>
-#include <stdlib.h>
 #include "WHardwareSerial.h"
 
 // Now, provide the class only if the hardware has at least one serial port.
 #if SERIALPORTS > 0
 
-#if !defined(RXCIE)
-// UCSRnA bits
-#define RXC    7
-#define UDRE   5
-#define U2X    1
-// UCSRnB bits
-#define RXCIE  7
-#define UDRIE  5
-#define RXEN   4
-#define TXEN   3
-// UCSRnC bits
-#define UPM1   5
-#define UPM0   4
-
-#endif
-
-#if !defined(SINGLEUSART1)
-      #if defined(UBRRL)
-      #define _UBRRH UBRRH
-      #define _UBRRL UBRRL
-      #define _UCSRA UCSRA
-      #define _UCSRB UCSRB
-      #define _UCSRC UCSRC
-      #define _UDR UDR
-      #else
-      #define _UBRRH UBRR0H
-      #define _UBRRL UBRR0L
-      #define _UCSRA UCSR0A
-      #define _UCSRB UCSR0B
-      #define _UCSRC UCSR0C
-      #define _UDR UDR0
-      #endif
+#if defined(SINGLEUSART1)
+#define _USART_RX_vect   USART1_RX_vect
+#define _USART_UDRE_vect USART1_UDRE_vect
+#elif defined(USART_RX_vect)
+#define _USART_RX_vect   USART_RX_vect
+#define _USART_UDRE_vect USART_UDRE_vect
+#elif defined(USART0_RX_vect)
+#define _USART_RX_vect   USART0_RX_vect
+#define _USART_UDRE_vect USART0_UDRE_vect
+#else
+#define _USART_RX_vect   USART_RXC_vect
+#define _USART_UDRE_vect USART_UDRE_vect
 #endif
-#if (SERIALPORTS > 1) || defined(SINGLEUSART1)
-      #define _UBRRH UBRR1H
-      #define _UBRRL UBRR1L
-      #define _UCSRA UCSR1A
-      #define _UCSRB UCSR1B
-      #define _UCSRC UCSR1C
-      #define _UDR UDR1
-#endif
-
-
-// Public Methods
-
-void HardwareSerial::begin(const uint32_t baud)
-{
-  // USART defaults on all supported AVRs to 81N
-
-  uint16_t ubrrValue;
-
-  // Calculate U2X ubrr (with rounding)
-  ubrrValue = (F_CPU/baud + 4) / 8;
-
-  // assign the baud_setting, a.k.a. ubbr (USART Baud Rate Register)
-  if (ubrrValue > 200) {
-    // error less than 0.5% so no need for U2X
-    ubrrValue = ubrrValue;
-    if ( ubrrValue >> 8 ) {
-      // UBRRH default is 0
-      _UBRRH = ubrrValue >> 8;
-    }
-  }
-  else {
-    _UCSRA = 1 << U2X;
-  }
-
-  _UBRRL = ubrrValue -1;
-  _UCSRB = (1 << RXEN) | (1 << TXEN);
-}
-
 
-void HardwareSerial::end()
+#if SERIAL_RX_BUFFER_SIZE > 0
+ISR(_USART_RX_vect)
 {
-  _UCSRB &= ~(1 << RXEN) | (1 << TXEN);
+  HardwareSerial::_rxInterrupt();
 }
+#endif
 
-
-int Stream::available(void)
-{
-  return (_UCSRA & (1<<RXC)); 
-}
-
-
-int Stream::read(void)
-{
-  if ( available() )
-    return _UDR;
-  else
-    return -1;
-}
-
-
-size_t Print::write(uint8_t c)
+#if SERIAL_TX_BUFFER_SIZE > 0
+ISR(_USART_UDRE_vect)
 {
-  // We will block here until we have some space free in the FIFO
-  while ( !(_UCSRA & (1<<UDRE)) ); 
-  _UDR = c;
-
-  return 1;
+  HardwareSerial::_udreInterrupt();
 }
+#endif
 
 
 // Preinstantiate
+#if !defined(SINGLEUSART1)
 HardwareSerial Serial;
+#else
+HardwareSerial Serial1;
+#endif
 
 #endif // SERIALPORTS > 0
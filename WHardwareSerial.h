@@ -50,24 +50,474 @@
 #endif
 #endif
 
+// Interrupt-driven receive buffer, off by default.  Define
+// SERIAL_RX_BUFFER_SIZE in the build flags (a power of two, 2 to 128)
+// to enable it; otherwise available()/read() poll the USART.
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 0
+#endif
+
+// Interrupt-driven transmit buffer, off by default.  With
+// SERIAL_TX_BUFFER_SIZE (a power of two, 2 to 128) defined, write()
+// queues bytes for the UDRE interrupt and returns; when the buffer is
+// full it waits for room, or returns 0 if SERIAL_TX_DROP is defined.
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 0
+#endif
+
+// Largest baud rate error begin<BAUD>() accepts, in tenths of a percent.
+// 2.5% still lets 16MHz parts talk at 115200 (2.1% with U2X).
+#ifndef SERIAL_BAUD_ERROR_MAX
+#define SERIAL_BAUD_ERROR_MAX 25
+#endif
+
 // Now, provide the class only if the hardware has at least one serial port.
 #if SERIALPORTS > 0
 
-class HardwareSerial : public Stream
+#if (SERIAL_RX_BUFFER_SIZE > 128) || \
+    (SERIAL_RX_BUFFER_SIZE & (SERIAL_RX_BUFFER_SIZE - 1))
+#error "SERIAL_RX_BUFFER_SIZE must be a power of two no larger than 128"
+#endif
+
+#if (SERIAL_TX_BUFFER_SIZE > 128) || \
+    (SERIAL_TX_BUFFER_SIZE & (SERIAL_TX_BUFFER_SIZE - 1))
+#error "SERIAL_TX_BUFFER_SIZE must be a power of two no larger than 128"
+#endif
+
+// Register block of one USART.  The accessors return the avr/io.h
+// registers, so every access compiles to a single in/out or lds/sts.
+#define WIRING_USART(NAME, CSRA, CSRB, CSRC, BRRH, BRRL, DR) \
+struct NAME \
+{ \
+  static volatile uint8_t &ucsra() { return CSRA; } \
+  static volatile uint8_t &ucsrb() { return CSRB; } \
+  static volatile uint8_t &ucsrc() { return CSRC; } \
+  static volatile uint8_t &ubrrh() { return BRRH; } \
+  static volatile uint8_t &ubrrl() { return BRRL; } \
+  static volatile uint8_t &udr() { return DR; } \
+}
+
+#if defined(UBRRL)
+// m8/m16/m32 style names
+WIRING_USART(_Usart0, UCSRA, UCSRB, UCSRC, UBRRH, UBRRL, UDR);
+#elif defined(UBRR0L)
+WIRING_USART(_Usart0, UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L, UDR0);
+#endif
+#if defined(UBRR1L)
+WIRING_USART(_Usart1, UCSR1A, UCSR1B, UCSR1C, UBRR1H, UBRR1L, UDR1);
+#endif
+
+
+// Baud rate setting: UBRR in the low 12 bits, U2X in the top bit
+struct _UsartBaud
+{
+  static const uint16_t U2X_SETTING = 0x8000;
+
+  // UBRR + 1 for a clock divider of 16 (normal) or 8 (U2X), rounded
+  static constexpr uint32_t divisor(uint32_t baud, uint8_t div)
+  {
+    return (F_CPU + baud * div / 2) / (baud * div);
+  }
+
+  static constexpr uint32_t absDiff(uint32_t a, uint32_t b)
+  {
+    return a > b ? a - b : b - a;
+  }
+
+  // bit time error of a divider in tenths of a percent; 1000 when
+  // the divisor doesn't fit UBRR
+  static constexpr uint16_t dividerError(uint32_t baud, uint8_t div)
+  {
+    return (divisor(baud, div) == 0 || divisor(baud, div) > 4096) ? 1000 :
+           (absDiff(div * divisor(baud, div) * baud, F_CPU) * 1000ULL
+            + F_CPU / 2) / F_CPU;
+  }
+
+  static constexpr uint16_t error(uint32_t baud)
+  {
+    return dividerError(baud, 16) <= dividerError(baud, 8) ?
+           dividerError(baud, 16) : dividerError(baud, 8);
+  }
+
+  // normal speed unless U2X gets closer; it samples fewer times per bit
+  static constexpr uint16_t setting(uint32_t baud)
+  {
+    return dividerError(baud, 16) <= dividerError(baud, 8) ?
+           divisor(baud, 16) - 1 : (divisor(baud, 8) - 1) | U2X_SETTING;
+  }
+
+  // runtime baud rates; one copy shared by all ports
+  static uint16_t runtimeSetting(uint32_t baud) __attribute__((noinline))
+  {
+    // U2X ubrr + 1 (with rounding); at least 1, the fastest rate
+    uint16_t ubrrValue = (F_CPU/baud + 4) / 8;
+    if (ubrrValue == 0) ubrrValue = 1;
+
+    // error less than 0.5% so no need for U2X; halve for the /16 divider
+    if (ubrrValue > 200) return (ubrrValue + 1) / 2 - 1;
+    return (ubrrValue - 1) | U2X_SETTING;
+  }
+};
+
+
+// One USART, selected by a register block from WIRING_USART.  All
+// state is static, so each port's read and write paths are direct
+// calls with constant register addresses.  The port's interrupt
+// handlers live with its instance in WHardwareSerial.cpp or
+// WHardwareSerial1.cpp, so an unused port costs no flash.
+template <class USART>
+class HardwareSerialPort : public Stream
 {
   public:
-    void begin(const uint32_t baud);
-    void end();
-    // rest of methods inherited
+    constexpr HardwareSerialPort() : Stream(&_sink, &_source) {}
+
+    // A constant baud is converted at compile time, so no 32-bit
+    // division is linked in; otherwise begin() divides at runtime.
+    inline void begin(const uint32_t baud) __attribute__((always_inline))
+    {
+      if (__builtin_constant_p(baud))
+        _init(_UsartBaud::setting(baud));
+      else
+        _init(_UsartBaud::runtimeSetting(baud));
+    }
+
+    // As begin(BAUD), but fails to compile when F_CPU can't get within
+    // SERIAL_BAUD_ERROR_MAX of BAUD.
+    template <uint32_t BAUD>
+    inline void begin()
+    {
+      static_assert(_UsartBaud::error(BAUD) <= SERIAL_BAUD_ERROR_MAX,
+                    "baud rate error too high for F_CPU");
+      _init(_UsartBaud::setting(BAUD));
+    }
+
+    void end()
+    {
+      USART::ucsrb() &= ~(_BV(RXCIEn) | _BV(UDRIEn) | _BV(RXENn) | _BV(TXENn));
+    }
+
+    int available();
+    int read() { return _read(); }
+    size_t write(uint8_t c) { return _write(c); }
+    using Print::write;
+    // waits until all written data has been sent
+    void flush();
+    // bytes write() can take without waiting
+    int availableForWrite();
+
+#if SERIAL_RX_BUFFER_SIZE > 0
+    int peek();
+
+    // bytes lost since begin() because the buffer was full, and
+    // because the ISR was held off for two character times (DOR)
+    uint16_t rxBufferOverflows() { return _atomicRead(&rxFull); }
+    uint16_t rxOverruns() { return _atomicRead(&rxLate); }
+
+#endif
+
+    // Bodies of the port's interrupt handlers; inlined so the handler
+    // saves only the registers it uses rather than all call-clobbered ones.
+#if SERIAL_RX_BUFFER_SIZE > 0
+    static inline void _rxInterrupt() __attribute__((always_inline));
+#endif
+#if SERIAL_TX_BUFFER_SIZE > 0
+    static inline void _udreInterrupt() __attribute__((always_inline))
+    {
+      _txNext();
+    }
+#endif
+
+  private:
+    // bit numbers, the same for every USART
+    enum { RXCn = 7, TXCn = 6, UDREn = 5, DORn = 3, U2Xn = 1 };
+    enum { RXCIEn = 7, UDRIEn = 5, RXENn = 4, TXENn = 3 };
+
+    static size_t _write(uint8_t c);
+    static int _read();
+    static void _init(uint16_t setting);
+
+    static size_t _sink(Print &, const uint8_t *buffer, size_t size)
+    {
+      size_t n = 0;
+      while (size--) n += _write(*buffer++);
+      return n;
+    }
+
+    static int _source(Stream &s, SourceRequest request)
+    {
+      HardwareSerialPort &port = static_cast<HardwareSerialPort &>(s);
+      if (request == READ) return _read();
+      if (request == AVAILABLE) return port.available();
+      port.flush();
+      return 0;
+    }
+
+    // Writing 1 clears TXC; FE, DOR and UPE must be written as 0.
+    static void _txSend(uint8_t c)
+    {
+      USART::ucsra() = (USART::ucsra() & _BV(U2Xn)) | _BV(TXCn);
+      USART::udr() = c;
+    }
+
+    // set once anything has been sent, so flush() knows TXC will come
+    static uint8_t txStarted;
+
+#if SERIAL_RX_BUFFER_SIZE > 0
+    // Single producer (the ISR) and single consumer (read()); each
+    // index is written by only one side, and byte stores are atomic, so
+    // neither side needs to disable interrupts.  The indices run freely
+    // and are masked on access, so head - tail is the fill level.
+    static const uint8_t RX_MASK = SERIAL_RX_BUFFER_SIZE - 1;
+    static volatile uint8_t rxBuffer[SERIAL_RX_BUFFER_SIZE];
+    static volatile uint8_t rxHead;
+    static volatile uint8_t rxTail;
+    static volatile uint16_t rxFull;
+    static volatile uint16_t rxLate;
+
+    static uint16_t _atomicRead(volatile uint16_t *counter)
+    {
+      uint8_t sreg = SREG;
+      cli();
+      uint16_t value = *counter;
+      SREG = sreg;
+      return value;
+    }
+#endif
+
+#if SERIAL_TX_BUFFER_SIZE > 0
+    // Same scheme as the RX buffer, with write() producing and the
+    // UDRE interrupt consuming.  UDRIE is set only while the buffer
+    // holds data.
+    static const uint8_t TX_MASK = SERIAL_TX_BUFFER_SIZE - 1;
+    static volatile uint8_t txBuffer[SERIAL_TX_BUFFER_SIZE];
+    static volatile uint8_t txHead;
+    static volatile uint8_t txTail;
+
+    static inline void _txNext() __attribute__((always_inline))
+    {
+      uint8_t tail = txTail;
+      _txSend(txBuffer[tail & TX_MASK]);
+      txTail = ++tail;
+      if ( tail == txHead ) USART::ucsrb() &= ~_BV(UDRIEn);
+    }
+
+    // With interrupts disabled the ISR can't run, so the waiting
+    // caller moves the next byte itself.
+    static void _txPoll()
+    {
+      if ( !(SREG & _BV(SREG_I)) && (USART::ucsra() & _BV(UDREn)) ) _txNext();
+    }
+#endif
 };
 
+
+template <class USART>
+uint8_t HardwareSerialPort<USART>::txStarted;
+
+template <class USART>
+void HardwareSerialPort<USART>::_init(uint16_t setting)
+{
+  // USART defaults on all supported AVRs to 81N
+
+  USART::ucsra() = (setting & _UsartBaud::U2X_SETTING) ? _BV(U2Xn) : 0;
+  USART::ubrrh() = (setting >> 8) & 0x0F;
+  USART::ubrrl() = setting;
+
+#if SERIAL_RX_BUFFER_SIZE > 0
+  rxTail = rxHead;
+  rxFull = 0;
+  rxLate = 0;
+  USART::ucsrb() = _BV(RXCIEn) | _BV(RXENn) | _BV(TXENn);
+  sei();
+#else
+  USART::ucsrb() = _BV(RXENn) | _BV(TXENn);
+#endif
+}
+
+
+template <class USART>
+int HardwareSerialPort<USART>::availableForWrite()
+{
+#if SERIAL_TX_BUFFER_SIZE > 0
+  return SERIAL_TX_BUFFER_SIZE - (uint8_t)(txHead - txTail);
+#else
+  return (USART::ucsra() & _BV(UDREn)) ? 1 : 0;
+#endif
+}
+
+
+#if SERIAL_RX_BUFFER_SIZE > 0
+
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::rxBuffer[SERIAL_RX_BUFFER_SIZE];
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::rxHead;
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::rxTail;
+template <class USART>
+volatile uint16_t HardwareSerialPort<USART>::rxFull;
+template <class USART>
+volatile uint16_t HardwareSerialPort<USART>::rxLate;
+
+template <class USART>
+inline void HardwareSerialPort<USART>::_rxInterrupt()
+{
+  // status must be read before UDR pops the hardware FIFO
+  uint8_t status = USART::ucsra();
+  uint8_t c = USART::udr();
+  if ( status & _BV(DORn) ) rxLate++;
+
+  uint8_t head = rxHead;
+  if ( (uint8_t)(head - rxTail) == SERIAL_RX_BUFFER_SIZE )
+  {
+    rxFull++;
+    return;
+  }
+  rxBuffer[head & RX_MASK] = c;
+  rxHead = head + 1;
+}
+
+
+template <class USART>
+int HardwareSerialPort<USART>::available()
+{
+  return (uint8_t)(rxHead - rxTail);
+}
+
+
+template <class USART>
+int HardwareSerialPort<USART>::peek()
+{
+  uint8_t tail = rxTail;
+  if ( rxHead == tail ) return -1;
+  return rxBuffer[tail & RX_MASK];
+}
+
+
+template <class USART>
+int HardwareSerialPort<USART>::_read()
+{
+  uint8_t tail = rxTail;
+  if ( rxHead == tail ) return -1;
+  uint8_t c = rxBuffer[tail & RX_MASK];
+  // frees the slot for the ISR only after the byte has been read
+  rxTail = tail + 1;
+  return c;
+}
+
+#else
+
+template <class USART>
+int HardwareSerialPort<USART>::available()
+{
+  return (USART::ucsra() & _BV(RXCn));
+}
+
+
+template <class USART>
+int HardwareSerialPort<USART>::_read()
+{
+  if ( USART::ucsra() & _BV(RXCn) )
+    return USART::udr();
+  else
+    return -1;
+}
+
+#endif
+
+
+#if SERIAL_TX_BUFFER_SIZE > 0
+
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::txBuffer[SERIAL_TX_BUFFER_SIZE];
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::txHead;
+template <class USART>
+volatile uint8_t HardwareSerialPort<USART>::txTail;
+
+template <class USART>
+size_t HardwareSerialPort<USART>::_write(uint8_t c)
+{
+  txStarted = 1;
+
+  uint8_t head = txHead;
+  // nothing queued and the data register free: skip the buffer
+  if ( head == txTail && (USART::ucsra() & _BV(UDREn)) )
+  {
+    _txSend(c);
+    return 1;
+  }
+
+  while ( (uint8_t)(head - txTail) == SERIAL_TX_BUFFER_SIZE )
+  {
+#if defined(SERIAL_TX_DROP)
+    return 0;
+#else
+    _txPoll();
+#endif
+  }
+
+  txBuffer[head & TX_MASK] = c;
+  txHead = head + 1;
+
+  // the ISR clears UDRIE with a read-modify-write of its own
+  uint8_t sreg = SREG;
+  cli();
+  USART::ucsrb() |= _BV(UDRIEn);
+  SREG = sreg;
+
+  return 1;
+}
+
+
+template <class USART>
+void HardwareSerialPort<USART>::flush()
+{
+  if ( !txStarted ) return;
+  while ( txHead != txTail ) _txPoll();
+  while ( !(USART::ucsra() & _BV(TXCn)) );
+}
+
+#else
+
+template <class USART>
+size_t HardwareSerialPort<USART>::_write(uint8_t c)
+{
+  // We will block here until we have some space free in the FIFO
+  while ( !(USART::ucsra() & _BV(UDREn)) );
+  _txSend(c);
+  txStarted = 1;
+
+  return 1;
+}
+
+
+template <class USART>
+void HardwareSerialPort<USART>::flush()
+{
+  if ( txStarted )
+    while ( !(USART::ucsra() & _BV(TXCn)) );
+}
+
+#endif
+
+
 #if !defined(SINGLEUSART1)
+typedef HardwareSerialPort<_Usart0> HardwareSerial;
 extern HardwareSerial Serial;
+#else
+// m32u4: the only USART is USART1
+typedef HardwareSerialPort<_Usart1> HardwareSerial;
 #endif
 #if SERIALPORTS > 1 || defined(SINGLEUSART1)
-extern HardwareSerial Serial1;
+typedef HardwareSerialPort<_Usart1> HardwareSerial1;
+extern HardwareSerial1 Serial1;
 #endif
 
+#else
+// No USART, so Serial is bit-banged
+#include <WSoftSerial.h>
+
 #endif // SERIALPORTS > 0
 
 #endif
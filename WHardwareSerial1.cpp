@@ -0,0 +1,41 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Serial1 on the second USART of the m164-1284 and m640-2560.
+|| | Kept apart from Serial so each port's interrupt handlers are
+|| | linked only when that port is used.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <avr/io.h>
+#include "WHardwareSerial.h"
+
+#if SERIALPORTS > 1 && !defined(SINGLEUSART1)
+
+#if SERIAL_RX_BUFFER_SIZE > 0
+ISR(USART1_RX_vect)
+{
+  HardwareSerial1::_rxInterrupt();
+}
+#endif
+
+#if SERIAL_TX_BUFFER_SIZE > 0
+ISR(USART1_UDRE_vect)
+{
+  HardwareSerial1::_udreInterrupt();
+}
+#endif
+
+
+// Preinstantiate
+HardwareSerial1 Serial1;
+
+#endif // SERIALPORTS > 1
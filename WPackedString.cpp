@@ -0,0 +1,113 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Dictionary packed flash strings for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "WPackedString.h"
+
+#define PACKED_CHUNK 8
+
+size_t PackedString::length() const
+{
+  const uint8_t *s = _packed;
+  size_t n = 0;
+  uint8_t c;
+  while ((c = pgm_read_byte(s++)))
+  {
+    if (c < 0x80)
+      n++;
+    else
+    {
+      const uint16_t *entry = _index + (c - 0x80);
+      n += pgm_read_word(entry + 1) - pgm_read_word(entry);
+    }
+  }
+  return n;
+}
+
+char *PackedString::decode(char *dst, char *end) const
+{
+  const uint8_t *s = _packed;
+  uint8_t c;
+
+  while (dst < end && (c = pgm_read_byte(s++)))
+  {
+    if (c < 0x80)
+    {
+      *dst++ = c;
+      continue;
+    }
+    const uint16_t *entry = _index + (c - 0x80);
+    const uint8_t *run = _dict + pgm_read_word(entry);
+    size_t n = pgm_read_word(entry + 1) - pgm_read_word(entry);
+    if (n > (size_t)(end - dst)) n = end - dst;
+    memcpy_P(dst, run, n);
+    dst += n;
+  }
+  return dst;
+}
+
+size_t PackedString::printTo(Print &p) const
+{
+  uint8_t buf[PACKED_CHUNK];
+  uint8_t len = 0;
+  size_t n = 0;
+  const uint8_t *s = _packed;
+  uint8_t c;
+
+  while ((c = pgm_read_byte(s++)))
+  {
+    // a literal is a one byte run of itself
+    const uint8_t *run = s - 1;
+    const uint8_t *end = s;
+    if (c >= 0x80)
+    {
+      const uint16_t *entry = _index + (c - 0x80);
+      run = _dict + pgm_read_word(entry);
+      end = _dict + pgm_read_word(entry + 1);
+    }
+
+    while (run < end)
+    {
+      buf[len++] = pgm_read_byte(run++);
+      if (len == sizeof(buf))
+      {
+        n += p.write(buf, len);
+        len = 0;
+      }
+    }
+  }
+
+  if (len) n += p.write(buf, len);
+  return n;
+}
+
+// String's PackedString members live here so that only sketches using
+// packed strings link the decoder.
+
+String::String(const PackedString &str)
+{
+  init();
+  *this = str;
+}
+
+String & String::operator = (const PackedString &str)
+{
+  return assignPart(_stringPart(str));
+}
+
+unsigned char String::concat(const PackedString &str)
+{
+  return concatPart(_stringPart(str));
+}
@@ -0,0 +1,81 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Dictionary packed flash strings for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | Wiring Common API
+|| #
+||
+|| @notes
+|| | tools/packstrings.py turns a list of strings into a shared
+|| | dictionary of up to 128 common substrings and one packed byte
+|| | string each: bytes below 0x80 are literal characters, and
+|| | 0x80 + n stands for dictionary entry n.  Entries are plain text,
+|| | so printing decodes straight from flash into the Print sink with
+|| | an 8-byte stack buffer and no recursion.
+|| #
+||
+|| @example
+|| | // help.txt:   help_set "set <name> <value>\r\n"
+|| | // then run:   tools/packstrings.py help.txt helptext
+|| | #include "helptext.h"
+|| | Serial.print(help_set);
+|| | String reply = help_set;      // decoded into the String's buffer
+|| | reply += err_range;
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WPACKEDSTRING_H
+#define WPACKEDSTRING_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include <Print.h>
+#include <Printable.h>
+
+class PackedString : public Printable
+{
+  public:
+    // all three in flash, as written by tools/packstrings.py
+    PackedString(const uint8_t *dict, const uint16_t *index,
+                 const uint8_t *packed)
+      : _dict(dict), _index(index), _packed(packed) {}
+
+    // length once decoded
+    size_t length() const;
+
+    // decodes into dst, stopping at end; returns where it stopped.
+    // No terminator is written.
+    char *decode(char *dst, char *end) const;
+
+    size_t printTo(Print &p) const;
+
+  private:
+    const uint8_t *_dict;
+    const uint16_t *_index;
+    const uint8_t *_packed;
+};
+
+// so a PackedString can be part of a String sum (WString.h)
+struct _StringPacked
+{
+  PackedString str;
+  unsigned int length() const { return str.length(); }
+  char *write(char *dst, char *end) const { return str.decode(dst, end); }
+  bool uses(const char *, unsigned int) const { return false; }
+};
+
+inline _StringPacked _stringPart(const PackedString &str)
+{
+  return _StringPacked{str};
+}
+
+#endif
+// WPACKEDSTRING_H
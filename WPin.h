@@ -0,0 +1,519 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Compile-time pin templates for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | The port register and bit of Pin<N> are resolved from the board's
+|| | constexpr pin table when the template is instantiated, and every
+|| | write is emitted as inline asm so it is a single sbi/cbi regardless
+|| | of optimization level.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @example
+|| | OutputPin<WLED> led;
+|| | InputPin<2, true> button;     // with pull-up
+|| | OpenDrainPin<3> oneWire;
+|| |
+|| | led.high();
+|| | if (button.read()) led.toggle();
+|| |
+|| | PinGroup<4, 5, 6, 7> lcdData;   // 4-bit bus on PORTD
+|| | lcdData.output();
+|| | lcdData.write(nibble);
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WPIN_H
+#define WPIN_H
+
+#include <avr/io.h>
+
+// Host builds (tests/) have no I/O instructions, so there every
+// register takes the memory-mapped path.
+#if defined(__AVR__)
+#define _REGBIT_IO(ADDR) ((ADDR) < 0x40)
+#else
+#define _REGBIT_IO(ADDR) false
+#endif
+
+// One bit of the register at data space address ADDR.  In the low I/O
+// space every access is a single sbi/cbi/sbis/sbic emitted as inline
+// asm, independent of optimization level.
+template <uint16_t ADDR, uint8_t BIT, bool IO = _REGBIT_IO(ADDR)>
+struct _RegBit
+{
+    static const uint8_t io = ADDR - __SFR_OFFSET;
+
+    static inline void set() __attribute__((always_inline))
+    {
+      asm volatile ("sbi %0, %1" :: "I" (io), "I" (BIT));
+    }
+
+    static inline void clear() __attribute__((always_inline))
+    {
+      asm volatile ("cbi %0, %1" :: "I" (io), "I" (BIT));
+    }
+
+    // write a 1 to just this bit; used on PINx to toggle PORTx
+    static inline void strobe() __attribute__((always_inline))
+    {
+      set();
+    }
+
+    // in/andi pair; returns the bit mask when set, 0 when clear
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      uint8_t value;
+      asm volatile ("in %0, %1" "\n\t"
+                    "andi %0, %2"
+                    : "=d" (value)
+                    : "I" (io), "M" (1 << BIT));
+      return value;
+    }
+
+    // busy-wait using sbis/sbic; 3 cycle polling loop
+    static inline void waitSet() __attribute__((always_inline))
+    {
+      asm volatile ("1: sbis %0, %1" "\n\t"
+                    "rjmp 1b" :: "I" (io), "I" (BIT));
+    }
+
+    static inline void waitClear() __attribute__((always_inline))
+    {
+      asm volatile ("1: sbic %0, %1" "\n\t"
+                    "rjmp 1b" :: "I" (io), "I" (BIT));
+    }
+};
+
+// Registers above the sbi/cbi range (PORTH-PORTL on the m2560) need an
+// lds/sts read-modify-write, which is done with interrupts disabled.
+template <uint16_t ADDR, uint8_t BIT>
+struct _RegBit<ADDR, BIT, false>
+{
+    static inline volatile uint8_t &reg() __attribute__((always_inline))
+    {
+      return _SFR_MEM8(ADDR);
+    }
+
+    static inline void set() __attribute__((always_inline))
+    {
+      uint8_t sreg = SREG;
+      cli();
+      reg() |= 1 << BIT;
+      SREG = sreg;
+    }
+
+    static inline void clear() __attribute__((always_inline))
+    {
+      uint8_t sreg = SREG;
+      cli();
+      reg() &= ~(1 << BIT);
+      SREG = sreg;
+    }
+
+    static inline void strobe() __attribute__((always_inline))
+    {
+      reg() = 1 << BIT;
+    }
+
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      return reg() & (1 << BIT);
+    }
+
+    static inline void waitSet() __attribute__((always_inline))
+    {
+      while (!read());
+    }
+
+    static inline void waitClear() __attribute__((always_inline))
+    {
+      while (read());
+    }
+};
+
+
+template <uint8_t N>
+class Pin
+{
+    static_assert(N < TOTAL_PINS, "Pin<N>: no such pin on this board");
+
+  public:
+    static const uint8_t port = digitalPinToPort(N);
+    static const uint8_t bit = digitalPinToBit(N);
+    static const uint8_t mask = 1 << bit;
+
+  private:
+    typedef _RegBit<portRegisterAddr(port, WIRING_PIN_REG), bit> PINx;
+    typedef _RegBit<portRegisterAddr(port, WIRING_DDR_REG), bit> DDRx;
+    typedef _RegBit<portRegisterAddr(port, WIRING_PORT_REG), bit> PORTx;
+
+  public:
+    // set the pin as an output (sbi DDRx)
+    static inline void output() __attribute__((always_inline))
+    {
+      DDRx::set();
+    }
+
+    // set the pin as an input (cbi DDRx), leaving the pull-up as it is
+    static inline void input() __attribute__((always_inline))
+    {
+      DDRx::clear();
+    }
+
+    // as pinMode(): INPUT also turns the pull-up off
+    static inline void mode(uint8_t MODE) __attribute__((always_inline))
+    {
+      // PORTx is set up before DDRx is cleared so the pin never floats
+      if (MODE == INPUT_PULLUP) high();
+      else if (MODE == OUTPUT_OPEN_DRAIN) low();
+
+      if (MODE == OUTPUT) output();
+      else input();
+
+      if (MODE == INPUT) low();
+    }
+
+    // sbi PORTx
+    static inline void high() __attribute__((always_inline))
+    {
+      PORTx::set();
+    }
+
+    // cbi PORTx
+    static inline void low() __attribute__((always_inline))
+    {
+      PORTx::clear();
+    }
+
+    static inline void write(uint8_t VALUE) __attribute__((always_inline))
+    {
+      if (VALUE) high();
+      else low();
+    }
+
+    // writing a 1 to PINx flips PORTx, so toggle is also one sbi
+    static inline void toggle() __attribute__((always_inline))
+    {
+      PINx::strobe();
+    }
+
+    // returns the pin mask when high, 0 when low
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      return PINx::read();
+    }
+
+    static inline void waitHigh() __attribute__((always_inline))
+    {
+      PINx::waitSet();
+    }
+
+    static inline void waitLow() __attribute__((always_inline))
+    {
+      PINx::waitClear();
+    }
+
+    Pin & operator = (uint8_t VALUE) __attribute__((always_inline))
+    {
+      write(VALUE);
+      return *this;
+    }
+
+    operator uint8_t() const __attribute__((always_inline))
+    {
+      return read();
+    }
+};
+
+
+// Pin that is made an output when the object is constructed
+template <uint8_t N>
+class OutputPin : public Pin<N>
+{
+  public:
+    OutputPin() __attribute__((always_inline))
+    {
+      Pin<N>::output();
+    }
+
+    using Pin<N>::operator =;
+};
+
+
+// Pin that is made an input, optionally with the pull-up enabled,
+// when the object is constructed
+template <uint8_t N, bool PULLUP = false>
+class InputPin : public Pin<N>
+{
+  public:
+    InputPin() __attribute__((always_inline))
+    {
+      Pin<N>::mode(PULLUP ? INPUT_PULLUP : INPUT);
+    }
+};
+
+
+// Open-drain pin: low() drives the pin low, high() releases it to an
+// external (or the other device's) pull-up.  DDRx is switched while
+// PORTx stays 0, so each write is still a single sbi/cbi.
+template <uint8_t N>
+class OpenDrainPin
+{
+    typedef Pin<N> P;
+
+  public:
+    OpenDrainPin() __attribute__((always_inline))
+    {
+      P::low();
+      P::input();
+    }
+
+    static inline void high() __attribute__((always_inline))
+    {
+      P::input();
+    }
+
+    static inline void low() __attribute__((always_inline))
+    {
+      P::output();
+    }
+
+    static inline void write(uint8_t VALUE) __attribute__((always_inline))
+    {
+      if (VALUE) high();
+      else low();
+    }
+
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      return P::read();
+    }
+
+    static inline void waitHigh() __attribute__((always_inline))
+    {
+      P::waitHigh();
+    }
+
+    static inline void waitLow() __attribute__((always_inline))
+    {
+      P::waitLow();
+    }
+
+    OpenDrainPin & operator = (uint8_t VALUE) __attribute__((always_inline))
+    {
+      write(VALUE);
+      return *this;
+    }
+
+    operator uint8_t() const __attribute__((always_inline))
+    {
+      return read();
+    }
+};
+
+
+/*************************************************************
+ * Pin groups
+ *************************************************************/
+
+// Compile-time walk over a group's pins.  I is the bit of the group
+// value that drives the first pin of the list.
+template <uint8_t I, uint8_t... Pins> struct _PinList;
+
+template <uint8_t I>
+struct _PinList<I>
+{
+  static constexpr uint8_t mask(uint8_t) { return 0; }
+  static constexpr int8_t shift(uint8_t) { return 0; }
+  static constexpr bool linear(uint8_t, int8_t) { return true; }
+  static inline uint8_t scatter(uint8_t, uint8_t) { return 0; }
+  static inline uint8_t gather(uint8_t, uint8_t) { return 0; }
+};
+
+template <uint8_t I, uint8_t P, uint8_t... Pins>
+struct _PinList<I, P, Pins...>
+{
+    static_assert(P < TOTAL_PINS, "PinGroup: no such pin on this board");
+    typedef _PinList<I + 1, Pins...> Next;
+
+    static constexpr bool on(uint8_t port)
+    {
+      return digitalPinToPort(P) == port;
+    }
+
+    // bits of PORT driven by the group
+    static constexpr uint8_t mask(uint8_t port)
+    {
+      return (on(port) ? digitalPinToBitMask(P) : 0) | Next::mask(port);
+    }
+
+    // port bit minus group bit, for the first of the group's pins on PORT
+    static constexpr int8_t shift(uint8_t port)
+    {
+      return on(port) ? digitalPinToBit(P) - I : Next::shift(port);
+    }
+
+    // true when every pin on PORT has the same shift, i.e. the group's
+    // bits for that port are in order and can be moved with one shift
+    static constexpr bool linear(uint8_t port, int8_t s)
+    {
+      return (!on(port) || digitalPinToBit(P) - I == s) &&
+             Next::linear(port, s);
+    }
+
+    // group value -> PORT bits, one bit at a time
+    static inline uint8_t scatter(uint8_t port, uint8_t value)
+      __attribute__((always_inline))
+    {
+      return ((on(port) && (value & (1 << I))) ? digitalPinToBitMask(P) : 0) |
+             Next::scatter(port, value);
+    }
+
+    // PINx bits -> group value, one bit at a time
+    static inline uint8_t gather(uint8_t port, uint8_t in)
+      __attribute__((always_inline))
+    {
+      return ((on(port) && (in & digitalPinToBitMask(P))) ? (1 << I) : 0) |
+             Next::gather(port, in);
+    }
+};
+
+// Per-port part of a group; recurses over every port of the board and
+// emits code only for ports that have pins in the group.
+template <uint8_t PORT, uint8_t... Pins>
+struct _PinGroupPort
+{
+    typedef _PinList<0, Pins...> List;
+    typedef _PinGroupPort<PORT + 1, Pins...> Next;
+
+    static const uint8_t mask = List::mask(PORT);
+    static const int8_t shift = List::shift(PORT);
+    static const bool linear = List::linear(PORT, shift);
+
+    static inline uint8_t toPort(uint8_t value) __attribute__((always_inline))
+    {
+      if (linear)
+        return (shift >= 0 ? value << shift : value >> -shift) & mask;
+      return List::scatter(PORT, value);
+    }
+
+    static inline uint8_t fromPort(uint8_t in) __attribute__((always_inline))
+    {
+      if (linear)
+        return shift >= 0 ? (in & mask) >> shift : (in & mask) << -shift;
+      return List::gather(PORT, in);
+    }
+
+    static inline void write(uint8_t value) __attribute__((always_inline))
+    {
+      if (mask)
+      {
+        // Flip the bits that differ by writing them to PINx.  Only the
+        // group's bits are touched, so an ISR changing other pins of
+        // the port between the read and the write is not undone, and
+        // all of the group's pins on this port change together.
+        *portInputRegister(PORT) =
+          (*portOutputRegister(PORT) ^ toPort(value)) & mask;
+      }
+      Next::write(value);
+    }
+
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      uint8_t value = 0;
+      if (mask) value = fromPort(*portInputRegister(PORT));
+      return value | Next::read();
+    }
+
+    static inline void mode(uint8_t MODE) __attribute__((always_inline))
+    {
+      if (mask)
+      {
+        // as Pin<N>::mode(), PORTx first so the pins never float
+        uint8_t sreg = SREG;
+        cli();
+        if (MODE == INPUT_PULLUP)
+          *portOutputRegister(PORT) |= mask;
+        else if (MODE == OUTPUT_OPEN_DRAIN)
+          *portOutputRegister(PORT) &= ~mask;
+
+        if (MODE == OUTPUT)
+          *portModeRegister(PORT) |= mask;
+        else
+          *portModeRegister(PORT) &= ~mask;
+
+        if (MODE == INPUT)
+          *portOutputRegister(PORT) &= ~mask;
+        SREG = sreg;
+      }
+      Next::mode(MODE);
+    }
+};
+
+template <uint8_t... Pins>
+struct _PinGroupPort<WIRING_PORTS, Pins...>
+{
+  static inline void write(uint8_t) {}
+  static inline uint8_t read() { return 0; }
+  static inline void mode(uint8_t) {}
+};
+
+
+// Up to 8 pins accessed as one value; bit 0 of the value is the first
+// pin.  Pins that share a port are written with one port access.
+template <uint8_t... Pins>
+class PinGroup
+{
+    static_assert(sizeof...(Pins) <= 8, "PinGroup: at most 8 pins");
+    typedef _PinGroupPort<0, Pins...> Ports;
+
+  public:
+    static inline void write(uint8_t value) __attribute__((always_inline))
+    {
+      Ports::write(value);
+    }
+
+    static inline uint8_t read() __attribute__((always_inline))
+    {
+      return Ports::read();
+    }
+
+    static inline void mode(uint8_t MODE) __attribute__((always_inline))
+    {
+      Ports::mode(MODE);
+    }
+
+    static inline void output() __attribute__((always_inline))
+    {
+      Ports::mode(OUTPUT);
+    }
+
+    static inline void input() __attribute__((always_inline))
+    {
+      Ports::mode(INPUT);
+    }
+
+    PinGroup & operator = (uint8_t value) __attribute__((always_inline))
+    {
+      write(value);
+      return *this;
+    }
+
+    operator uint8_t() const __attribute__((always_inline))
+    {
+      return read();
+    }
+};
+
+#endif
+// WPIN_H
@@ -0,0 +1,98 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Bit-banged Serial for
+|| | Atmel AVR 8 bit microcontrollers without a USART.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <util/delay_basic.h>
+#include "Wiring.h"
+
+// Only used when the hardware has no serial port.
+#if SERIALPORTS == 0
+
+// _delay_loop_2 count for one bit time (_SoftSerialBaud)
+static uint16_t bitLoops;
+
+
+void SoftSerial::_begin(uint16_t loops)
+{
+  bitLoops = loops;
+
+  // idle high
+  Pin<TX0>::high();
+  Pin<TX0>::output();
+  Pin<RX0>::mode(INPUT_PULLUP);
+}
+
+
+int SoftSerial::available(void)
+{
+  // low line means a start bit is arriving
+  return !Pin<RX0>::read();
+}
+
+
+int SoftSerial::_read(void)
+{
+  if ( !available() ) return -1;
+
+  uint16_t loops = bitLoops;
+  uint8_t c = 0;
+
+  uint8_t sreg = SREG;
+  cli();
+  // to the middle of the start bit, then sample each data bit
+  _delay_loop_2((loops + 1) / 2);
+  for (uint8_t i = 8; i; i--)
+  {
+    _delay_loop_2(loops);
+    c >>= 1;
+    if (Pin<RX0>::read()) c |= 0x80;
+  }
+  // the middle of the stop bit, sampled as a USART does; low is a
+  // framing error, such as a break or an RX line stuck low
+  _delay_loop_2(loops);
+  uint8_t stop = Pin<RX0>::read();
+  SREG = sreg;
+
+  return stop ? c : -1;
+}
+
+
+size_t SoftSerial::_write(uint8_t c)
+{
+  uint16_t loops = bitLoops;
+
+  uint8_t sreg = SREG;
+  cli();
+  Pin<TX0>::low();        // start bit
+  _delay_loop_2(loops);
+  for (uint8_t i = 8; i; i--)
+  {
+    if (c & 1) Pin<TX0>::high();
+    else Pin<TX0>::low();
+    c >>= 1;
+    _delay_loop_2(loops);
+  }
+  Pin<TX0>::high();       // stop bit
+  SREG = sreg;
+  _delay_loop_2(loops);
+
+  return 1;
+}
+
+
+// Preinstantiate
+SoftSerial Serial;
+
+#endif // SERIALPORTS == 0
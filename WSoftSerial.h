@@ -0,0 +1,109 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Bit-banged Serial for
+|| | Atmel AVR 8 bit microcontrollers without a USART.
+|| |
+|| | 8N1 on the board's TX0/RX0 pins.  Interrupts are disabled while a
+|| | byte is shifted.  Like the polled HardwareSerial, read() must be
+|| | called while the start bit is arriving.  A byte without its stop
+|| | bit, as when the line is held low, reads as -1 after one frame.
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WSOFTSERIAL_H
+#define WSOFTSERIAL_H
+
+#include <inttypes.h>
+#include <Stream.h>
+
+// Bit timing: a bit is a _delay_loop_2 count (4 cycles each) plus the
+// cycles the tx/rx loops spend around it
+struct _SoftSerialBaud
+{
+  static const uint8_t BIT_OVERHEAD = 8;
+
+  // rounded, and clamped to what _delay_loop_2 can count, where 0
+  // would mean 65536; the slowest rate is then 61 baud at 16 MHz
+  static constexpr uint16_t loops(uint32_t cyclesPerBit)
+  {
+    return cyclesPerBit < BIT_OVERHEAD + 2 + 4 ? 1 :
+           cyclesPerBit >= BIT_OVERHEAD - 2 + 4 * 0xFFFFUL ? 0xFFFF :
+           (cyclesPerBit - BIT_OVERHEAD + 2) / 4;
+  }
+
+  static constexpr uint32_t absDiff(uint32_t a, uint32_t b)
+  {
+    return a > b ? a - b : b - a;
+  }
+
+  // bit time error in tenths of a percent
+  static constexpr uint16_t error(uint32_t baud)
+  {
+    return (absDiff((4UL * loops(F_CPU / baud) + BIT_OVERHEAD) * baud, F_CPU)
+            * 1000ULL + F_CPU / 2) / F_CPU;
+  }
+};
+
+class SoftSerial : public Stream
+{
+  public:
+    constexpr SoftSerial() : Stream(&_sink, &_source) {}
+
+    // inline so the bit timing is computed at compile time for a
+    // constant baud
+    inline void begin(const uint32_t baud)
+    {
+      _begin(_SoftSerialBaud::loops(F_CPU / baud));
+    }
+
+    // As begin(BAUD), but fails to compile when F_CPU can't get within
+    // SERIAL_BAUD_ERROR_MAX of BAUD.
+    template <uint32_t BAUD>
+    inline void begin()
+    {
+      static_assert(_SoftSerialBaud::error(BAUD) <= SERIAL_BAUD_ERROR_MAX,
+                    "baud rate error too high for F_CPU");
+      _begin(_SoftSerialBaud::loops(F_CPU / BAUD));
+    }
+    void end() {}
+
+    static int available();
+    int read() { return _read(); }
+    size_t write(uint8_t c) { return _write(c); }
+    using Print::write;
+    // write() returns only after the stop bit
+    void flush() {}
+
+  private:
+    static void _begin(uint16_t loops);
+    static size_t _write(uint8_t c);
+    static int _read();
+
+    static size_t _sink(Print &, const uint8_t *buffer, size_t size)
+    {
+      size_t n = 0;
+      while (size--) n += _write(*buffer++);
+      return n;
+    }
+
+    static int _source(Stream &, SourceRequest request)
+    {
+      if (request == READ) return _read();
+      if (request == AVAILABLE) return available();
+      return 0;
+    }
+};
+
+extern SoftSerial Serial;
+
+#endif
+// WSOFTSERIAL_H
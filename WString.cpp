@@ -38,7 +38,7 @@ String::String(const String &value)
   *this = value;
 }
 
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
+#if __cplusplus >= 201103L
 String::String(String &&rval)
 {
   init();
@@ -103,64 +103,133 @@ String::String(unsigned long value, unsigned char base)
 String::String(float value, unsigned char decimalPlaces)
 {
 	init();
-	char buf[33];
-	*this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+	char buf[FORMAT_BUFFER_SIZE];
+	copy(buf, _floatFormat(buf, value, decimalPlaces));
 }
 
 String::String(double value, unsigned char decimalPlaces)
 {
 	init();
-	char buf[33];
-	*this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+	char buf[FORMAT_BUFFER_SIZE];
+	copy(buf, _floatFormat(buf, value, decimalPlaces));
+}
+
+String::String(char *storage, unsigned int size)
+{
+  store.buffer = storage;
+  store.buffer[0] = 0;
+  store.capacity = size;
+  len = 0;
+  flags = STRING_FIXED;
 }
 
 String::~String()
 {
-  free(buffer);
+  if (flags & STRING_HEAP) free(store.buffer);
 }
 
 /*********************************************/
 /*  Memory Management                        */
 /*********************************************/
 
-inline void String::init(void)
-{
-  buffer = NULL;
-  capacity = 0;
-  len = 0;
-  flags = 0;
-}
-
 void String::invalidate(void)
 {
-  if (buffer) free(buffer);
-  buffer = NULL;
-  capacity = len = 0;
+  if (flags & STRING_FIXED)
+  {
+    store.buffer[0] = 0;
+    len = 0;
+    return;
+  }
+  if (flags & STRING_HEAP) free(store.buffer);
+  init();
 }
 
 unsigned char String::reserve(unsigned int size)
 {
-  if (buffer && capacity >= size) return 1;
+  if (buffer() && capacity() >= size) return 1;
   if (changeBuffer(size))
   {
-    if (len == 0) buffer[0] = 0;
+    if (len == 0) buffer()[0] = 0;
     return 1;
   }
   return 0;
 }
 
+// Short strings use the inline buffer.  Once a string outgrows it, it
+// moves to the heap and stays there until invalidated.
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-  char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
+  if (flags & STRING_FIXED) return maxStrLen <= store.capacity;
+  if (!(flags & STRING_HEAP))
+  {
+    if (maxStrLen <= STRING_INLINE_CAPACITY)
+    {
+      flags |= STRING_INLINE;
+      return 1;
+    }
+    char *newbuffer = (char *)malloc(maxStrLen + 1);
+    if (!newbuffer) return 0;
+    // the inline characters share their bytes with store
+    if (flags & STRING_INLINE) memcpy(newbuffer, inlineBuffer, len + 1);
+    store.buffer = newbuffer;
+    store.capacity = maxStrLen;
+    flags = (flags & ~STRING_INLINE) | STRING_HEAP;
+    return 1;
+  }
+
+  char *newbuffer = (char *)realloc(store.buffer, maxStrLen + 1);
   if (newbuffer)
   {
-    buffer = newbuffer;
-    capacity = maxStrLen;
+    store.buffer = newbuffer;
+    store.capacity = maxStrLen;
+    return 1;
+  }
+  return 0;
+}
+
+// Room for maxStrLen characters plus growth slack, or exactly
+// maxStrLen if the slack can't be had.
+unsigned char String::grow(unsigned int maxStrLen)
+{
+  if (buffer() && capacity() >= maxStrLen) return 1;
+  if (!(flags & STRING_HEAP) && maxStrLen <= STRING_INLINE_CAPACITY)
+    return reserve(maxStrLen);
+
+  unsigned int slack = maxStrLen / 2;
+  if (slack > STRING_GROWTH_MAX) slack = STRING_GROWTH_MAX;
+  if (changeBuffer(maxStrLen + slack) || changeBuffer(maxStrLen))
+  {
+    if (len == 0) buffer()[0] = 0;
     return 1;
   }
   return 0;
 }
 
+// Room for the string to reach maxStrLen characters, with growth slack
+// or exactly; returns the end of the room, short of maxStrLen if a
+// StaticString is full, or NULL if there is none.
+char *String::extend(unsigned int maxStrLen, unsigned char slack)
+{
+  if (slack ? grow(maxStrLen) : reserve(maxStrLen)) return buffer() + maxStrLen;
+  if (!(flags & STRING_FIXED)) return NULL;
+  flags |= STRING_TRUNCATED;
+  return store.buffer + store.capacity;
+}
+
+void String::shrink_to_fit(void)
+{
+  if (!(flags & STRING_HEAP) || store.capacity == len) return;
+  if (len <= STRING_INLINE_CAPACITY)
+  {
+    char *heap = store.buffer;
+    memcpy(inlineBuffer, heap, len + 1);
+    free(heap);
+    flags = (flags & ~STRING_HEAP) | STRING_INLINE;
+    return;
+  }
+  changeBuffer(len);
+}
+
 /*********************************************/
 /*  Copy and Move                            */
 /*********************************************/
@@ -169,51 +238,73 @@ String & String::copy(const char *cstr, unsigned int length)
 {
   if (!reserve(length))
   {
-    invalidate();
-    return *this;
+    if (!(flags & STRING_FIXED))
+    {
+      invalidate();
+      return *this;
+    }
+    length = store.capacity;
+    flags |= STRING_TRUNCATED;
   }
   len = length;
-  strcpy(buffer, cstr);
+  char *b = buffer();
+  memmove(b, cstr, length);
+  b[length] = 0;
   return *this;
 }
 
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
+// Takes over rhs's characters, leaving rhs empty.  A heap buffer
+// changes hands and inline characters are copied, so neither
+// allocates.  A StaticString's storage belongs to its object, so
+// moving from or to one copies the characters.
 void String::move(String &rhs)
 {
-  if (buffer)
+  if (!rhs.buffer())
   {
-    if (capacity >= rhs.len)
-    {
-      strcpy(buffer, rhs.buffer);
-      len = rhs.len;
-      rhs.len = 0;
-      return;
-    }
-    else
-    {
-      free(buffer);
-    }
+    invalidate();
+    return;
+  }
+  if ((flags | rhs.flags) & STRING_FIXED)
+  {
+    copy(rhs.buffer(), rhs.len);
+    rhs.len = 0;
+    rhs.buffer()[0] = 0;
+    return;
   }
-  buffer = rhs.buffer;
-  capacity = rhs.capacity;
+  if (flags & STRING_HEAP) free(store.buffer);
+  if (rhs.flags & STRING_INLINE)
+    memcpy(inlineBuffer, rhs.inlineBuffer, rhs.len + 1);
+  else
+    store = rhs.store;
   len = rhs.len;
-  rhs.buffer = NULL;
-  rhs.capacity = 0;
+  flags = rhs.flags;
   rhs.len = 0;
+  rhs.flags = STRING_INLINE;
+  rhs.inlineBuffer[0] = 0;
+}
+
+// Three moves, none of which allocates unless one side is a
+// StaticString.
+void String::swap(String &rhs)
+{
+  if (this == &rhs) return;
+  String temp;
+  temp.move(*this);
+  move(rhs);
+  rhs.move(temp);
 }
-#endif
 
 String & String::operator = (const String &rhs)
 {
   if (this == &rhs) return *this;
 
-  if (rhs.buffer) copy(rhs.buffer, rhs.len);
+  if (rhs.buffer()) copy(rhs.buffer(), rhs.len);
   else invalidate();
 
   return *this;
 }
 
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
+#if __cplusplus >= 201103L
 String & String::operator = (String && rval)
 {
   if (this != &rval) move(rval);
@@ -241,7 +332,7 @@ String & String::operator = (const char *cstr)
 
 unsigned char String::concat(const String &s)
 {
-  return concat(s.buffer, s.len);
+  return concat(s.buffer(), s.len);
 }
 
 unsigned char String::concat(const char *cstr, unsigned int length)
@@ -249,10 +340,25 @@ unsigned char String::concat(const char *cstr, unsigned int length)
   unsigned int newlen = len + length;
   if (!cstr) return 0;
   if (length == 0) return 1;
-  if (!reserve(newlen)) return 0;
-  strcpy(buffer + len, cstr);
+  // s += s: reserve() may move the buffer cstr points into
+  char *b = buffer();
+  bool self = b && cstr >= b && cstr <= b + len;
+  unsigned int offset = cstr - b;
+  unsigned char fits = grow(newlen);
+  if (!fits)
+  {
+    // a fixed buffer keeps as much as fits
+    if (!(flags & STRING_FIXED)) return 0;
+    flags |= STRING_TRUNCATED;
+    length = store.capacity - len;
+    newlen = store.capacity;
+  }
+  b = buffer();
+  if (self) cstr = b + offset;
+  memcpy(b + len, cstr, length);
+  b[newlen] = 0;
   len = newlen;
-  return 1;
+  return fits;
 }
 
 unsigned char String::concat(const char *cstr)
@@ -306,90 +412,14 @@ unsigned char String::concat(unsigned long num)
 
 unsigned char String::concat(float num)
 {
-	char buf[20];
-	char* string = dtostrf(num, 4, 2, buf);
-	return concat(string, strlen(string));
+	char buf[FORMAT_BUFFER_SIZE];
+	return concat(buf, _floatFormat(buf, num, 2));
 }
 
 unsigned char String::concat(double num)
 {
-	char buf[20];
-	char* string = dtostrf(num, 4, 2, buf);
-	return concat(string, strlen(string));
-}
-
-/*********************************************/
-/*  Concatenate                              */
-/*********************************************/
-
-StringSumHelper & operator + (const StringSumHelper &lhs, const String &rhs)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(rhs.buffer, rhs.len)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, const char *cstr)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!cstr || !a.concat(cstr, strlen(cstr))) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, char c)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(c)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, unsigned char num)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(num)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, int num)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(num)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, unsigned int num)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(num)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, long num)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(num)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, unsigned long num)
-{
-  StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-  if (!a.concat(num)) a.invalidate();
-  return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, float num)
-{
-	StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-	if (!a.concat(num)) a.invalidate();
-	return a;
-}
-
-StringSumHelper & operator + (const StringSumHelper &lhs, double num)
-{
-	StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-	if (!a.concat(num)) a.invalidate();
-	return a;
+	char buf[FORMAT_BUFFER_SIZE];
+	return concat(buf, _floatFormat(buf, num, 2));
 }
 
 /*********************************************/
@@ -398,13 +428,14 @@ StringSumHelper & operator + (const StringSumHelper &lhs, double num)
 
 int String::compareTo(const String &s) const
 {
-  if (!buffer || !s.buffer)
+  const char *b = buffer(), *sb = s.buffer();
+  if (!b || !sb)
   {
-    if (s.buffer && s.len > 0) return 0 - *(unsigned char *)s.buffer;
-    if (buffer && len > 0) return *(unsigned char *)buffer;
+    if (sb && s.len > 0) return 0 - *(unsigned char *)sb;
+    if (b && len > 0) return *(unsigned char *)b;
     return 0;
   }
-  return strcmp(buffer, s.buffer);
+  return strcmp(b, sb);
 }
 
 unsigned char String::equals(const String &s2) const
@@ -415,8 +446,8 @@ unsigned char String::equals(const String &s2) const
 unsigned char String::equals(const char *cstr) const
 {
   if (len == 0) return (cstr == NULL || *cstr == 0);
-  if (cstr == NULL) return buffer[0] == 0;
-  return strcmp(buffer, cstr) == 0;
+  if (cstr == NULL) return buffer()[0] == 0;
+  return strcmp(buffer(), cstr) == 0;
 }
 
 unsigned char String::operator<(const String &rhs) const
@@ -444,8 +475,8 @@ unsigned char String::equalsIgnoreCase(const String &s2) const
   if (this == &s2) return 1;
   if (len != s2.len) return 0;
   if (len == 0) return 1;
-  const char *p1 = buffer;
-  const char *p2 = s2.buffer;
+  const char *p1 = buffer();
+  const char *p2 = s2.buffer();
   while (*p1)
   {
     if (tolower(*p1++) != tolower(*p2++)) return 0;
@@ -461,14 +492,14 @@ unsigned char String::startsWith(const String &s2) const
 
 unsigned char String::startsWith(const String &s2, unsigned int offset) const
 {
-  if (offset > len - s2.len || !buffer || !s2.buffer) return 0;
-  return strncmp(&buffer[offset], s2.buffer, s2.len) == 0;
+  if (offset > len - s2.len || !buffer() || !s2.buffer()) return 0;
+  return strncmp(&buffer()[offset], s2.buffer(), s2.len) == 0;
 }
 
 unsigned char String::endsWith(const String &s2) const
 {
-  if (len < s2.len || !buffer || !s2.buffer) return 0;
-  return strcmp(&buffer[len - s2.len], s2.buffer) == 0;
+  if (len < s2.len || !buffer() || !s2.buffer()) return 0;
+  return strcmp(&buffer()[len - s2.len], s2.buffer()) == 0;
 }
 
 /*********************************************/
@@ -482,24 +513,24 @@ char String::charAt(unsigned int loc) const
 
 void String::setCharAt(unsigned int loc, char c)
 {
-  if (loc < len) buffer[loc] = c;
+  if (loc < len) buffer()[loc] = c;
 }
 
 char & String::operator[](unsigned int index)
 {
   static char dummy_writable_char;
-  if (index >= len || !buffer)
+  if (index >= len || !buffer())
   {
     dummy_writable_char = 0;
     return dummy_writable_char;
   }
-  return buffer[index];
+  return buffer()[index];
 }
 
 char String::operator[](unsigned int index) const
 {
-  if (index >= len || !buffer) return 0;
-  return buffer[index];
+  if (index >= len || !buffer()) return 0;
+  return buffer()[index];
 }
 
 void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
@@ -512,7 +543,7 @@ void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int ind
   }
   unsigned int n = bufsize - 1;
   if (n > len - index) n = len - index;
-  strncpy((char *)buf, buffer + index, n);
+  strncpy((char *)buf, buffer() + index, n);
   buf[n] = 0;
 }
 
@@ -528,9 +559,9 @@ int String::indexOf(char c) const
 int String::indexOf(char ch, unsigned int fromIndex) const
 {
   if (fromIndex >= len) return -1;
-  const char* temp = strchr(buffer + fromIndex, ch);
+  const char* temp = strchr(buffer() + fromIndex, ch);
   if (temp == NULL) return -1;
-  return temp - buffer;
+  return temp - buffer();
 }
 
 int String::indexOf(const String &s2) const
@@ -541,9 +572,9 @@ int String::indexOf(const String &s2) const
 int String::indexOf(const String &s2, unsigned int fromIndex) const
 {
   if (fromIndex >= len) return -1;
-  const char *found = strstr(buffer + fromIndex, s2.buffer);
+  const char *found = strstr(buffer() + fromIndex, s2.buffer());
   if (found == NULL) return -1;
-  return found - buffer;
+  return found - buffer();
 }
 
 int String::lastIndexOf(char theChar) const
@@ -554,12 +585,13 @@ int String::lastIndexOf(char theChar) const
 int String::lastIndexOf(char ch, int fromIndex) const
 {
   if (fromIndex >= len || fromIndex < 0) return -1;
-  char tempchar = buffer[fromIndex + 1];
-  buffer[fromIndex + 1] = '\0';
-  char* temp = strrchr(buffer, ch);
-  buffer[fromIndex + 1] = tempchar;
+  char *b = buffer();
+  char tempchar = b[fromIndex + 1];
+  b[fromIndex + 1] = '\0';
+  char* temp = strrchr(b, ch);
+  b[fromIndex + 1] = tempchar;
   if (temp == NULL) return -1;
-  return temp - buffer;
+  return temp - b;
 }
 
 int String::lastIndexOf(const String &s2) const
@@ -572,11 +604,12 @@ int String::lastIndexOf(const String &s2, int fromIndex) const
   if (s2.len == 0 || len == 0 || s2.len > len || fromIndex < 0) return -1;
   if (fromIndex >= len) fromIndex = len - 1;
   int found = -1;
-  for (char *p = buffer; p <= buffer + fromIndex; p++)
+  char *b = buffer();
+  for (char *p = b; p <= b + fromIndex; p++)
   {
-    p = strstr(p, s2.buffer);
+    p = strstr(p, s2.buffer());
     if (!p) break;
-    if (p - buffer <= fromIndex) found = p - buffer;
+    if (p - b <= fromIndex) found = p - b;
   }
   return found;
 }
@@ -592,10 +625,11 @@ String String::substring(unsigned int left, unsigned int right) const
   String out;
   if (left > len) return out;
   if (right > len) right = len;
-  char temp = buffer[right];  // save the replaced character
-  buffer[right] = '\0';
-  out = buffer + left;  // pointer arithmetic
-  buffer[right] = temp;  //restore character
+  char *b = buffer();
+  char temp = b[right];  // save the replaced character
+  b[right] = '\0';
+  out = b + left;  // pointer arithmetic
+  b[right] = temp;  //restore character
   return out;
 }
 
@@ -605,8 +639,8 @@ String String::substring(unsigned int left, unsigned int right) const
 
 void String::replace(char find, char replace)
 {
-  if (!buffer) return;
-  for (char *p = buffer; *p; p++)
+  if (!buffer()) return;
+  for (char *p = buffer(); *p; p++)
   {
     if (*p == find) *p = replace;
   }
@@ -616,49 +650,58 @@ void String::replace(const String& find, const String& replace)
 {
   if (len == 0 || find.len == 0) return;
   int diff = replace.len - find.len;
-  char *readFrom = buffer;
+  char *readFrom = buffer();
   char *foundAt;
   if (diff == 0)
   {
-    while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+    while ((foundAt = strstr(readFrom, find.buffer())) != NULL)
     {
-      memcpy(foundAt, replace.buffer, replace.len);
+      memcpy(foundAt, replace.buffer(), replace.len);
       readFrom = foundAt + replace.len;
     }
   }
   else if (diff < 0)
   {
-    char *writeTo = buffer;
-    while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+    char *writeTo = buffer();
+    while ((foundAt = strstr(readFrom, find.buffer())) != NULL)
     {
       unsigned int n = foundAt - readFrom;
-      memcpy(writeTo, readFrom, n);
+      memmove(writeTo, readFrom, n);
       writeTo += n;
-      memcpy(writeTo, replace.buffer, replace.len);
+      memcpy(writeTo, replace.buffer(), replace.len);
       writeTo += replace.len;
       readFrom = foundAt + find.len;
       len += diff;
     }
-    strcpy(writeTo, readFrom);
+    memmove(writeTo, readFrom, strlen(readFrom) + 1);
   }
   else
   {
     unsigned int size = len; // compute size needed for result
-    while ((foundAt = strstr(readFrom, find.buffer)) != NULL)
+    while ((foundAt = strstr(readFrom, find.buffer())) != NULL)
     {
       readFrom = foundAt + find.len;
       size += diff;
     }
     if (size == len) return;
-    if (size > capacity && !changeBuffer(size)) return; // XXX: tell user!
+    if (size > capacity() && !changeBuffer(size))
+    {
+      // no room for the result: a String is invalidated, as when a
+      // copy fails, and a full StaticString is left as it was, marked
+      // truncated
+      if (flags & STRING_FIXED) flags |= STRING_TRUNCATED;
+      else invalidate();
+      return;
+    }
+    char *b = buffer();
     int index = len - 1;
     while ((index = lastIndexOf(find, index)) >= 0)
     {
-      readFrom = buffer + index + find.len;
-      memmove(readFrom + diff, readFrom, len - (readFrom - buffer));
+      readFrom = b + index + find.len;
+      memmove(readFrom + diff, readFrom, len - (readFrom - b));
       len += diff;
-      buffer[len] = 0;
-      memcpy(buffer + index, replace.buffer, replace.len);
+      b[len] = 0;
+      memcpy(b + index, replace.buffer(), replace.len);
       index--;
     }
   }
@@ -674,16 +717,17 @@ void String::remove(unsigned int index, unsigned int count){
 	if (index >= len) { return; }
 	if (count <= 0) { return; }
 	if (index + count > len) { count = len - index; }
-	char *writeTo = buffer + index;
+	char *b = buffer();
+	char *writeTo = b + index;
 	len = len - count;
-	strncpy(writeTo, buffer + index + count,len - index);
-	buffer[len] = 0;
+	memmove(writeTo, b + index + count, len - index);
+	b[len] = 0;
 }
 
 void String::toLowerCase(void)
 {
-  if (!buffer) return;
-  for (char *p = buffer; *p; p++)
+  if (!buffer()) return;
+  for (char *p = buffer(); *p; p++)
   {
     *p = tolower(*p);
   }
@@ -691,8 +735,8 @@ void String::toLowerCase(void)
 
 void String::toUpperCase(void)
 {
-  if (!buffer) return;
-  for (char *p = buffer; *p; p++)
+  if (!buffer()) return;
+  for (char *p = buffer(); *p; p++)
   {
     *p = toupper(*p);
   }
@@ -700,14 +744,15 @@ void String::toUpperCase(void)
 
 void String::trim(void)
 {
-  if (!buffer || len == 0) return;
-  char *begin = buffer;
+  char *b = buffer();
+  if (!b || len == 0) return;
+  char *begin = b;
   while (isspace(*begin)) begin++;
-  char *end = buffer + len - 1;
+  char *end = b + len - 1;
   while (isspace(*end) && end >= begin) end--;
   len = end + 1 - begin;
-  if (begin > buffer) memcpy(buffer, begin, len);
-  buffer[len] = 0;
+  if (begin > b) memmove(b, begin, len);
+  b[len] = 0;
 }
 
 /*********************************************/
@@ -716,7 +761,7 @@ void String::trim(void)
 
 long String::toInt(void) const
 {
-  if (buffer) return atol(buffer);
+  if (buffer()) return atol(buffer());
   return 0;
 }
 
@@ -23,9 +23,11 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <avr/io.h>
 #include <avr/pgmspace.h>
 
 #include "WVector.h"
+#include "WFixed.h"
 //#include "Printable.h"
 
 // When compiling programs with this class, the following gcc parameters
@@ -34,9 +36,34 @@
 //     -felide-constructors
 //     -std=c++0x
 
-// An inherited class for holding the result of a concatenation.  These
-// result objects are assumed to be writable by subsequent concatenations.
+// Strings up to this many characters are kept in the object itself,
+// in the bytes that hold a longer string's heap pointer and capacity,
+// and never touch the heap.  The default fills those bytes: 3
+// characters on AVR, where sizeof(String) is 7 bytes as it was before
+// strings were kept inline.  A larger value makes every String bigger,
+// e.g. 11, which holds any long in decimal, makes it 15 bytes.
+#ifndef STRING_INLINE_CAPACITY
+#define STRING_INLINE_CAPACITY (sizeof(char *) + sizeof(unsigned int) - 1)
+#endif
+
+// When concat() has to enlarge a heap buffer it adds half the new
+// length again as room to grow, up to STRING_GROWTH_MAX bytes, so a
+// string built a character at a time is reallocated O(log n) times
+// rather than once per character.
+#ifndef STRING_GROWTH_MAX
+#if RAMEND < 0x500
+#define STRING_GROWTH_MAX 16
+#else
+#define STRING_GROWTH_MAX 64
+#endif
+#endif
+
+// An inherited class that held the result of a concatenation before
+// operator + built a _StringCat; kept for code that names it.
 class StringSumHelper;
+// a + b + ..., built in one go when assigned (see operator + below)
+template <class L, class R> struct _StringCat;
+class PackedString;
 
 // The string class
 class String
@@ -55,7 +82,7 @@ class String
     // be false).
     String(const char *cstr = "");
     String(const String &str);
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
+#if __cplusplus >= 201103L
     String(String && rval);
     String(StringSumHelper && rval);
 #endif
@@ -67,6 +94,22 @@ class String
     explicit String(unsigned long, unsigned char base = 10);
     explicit String(float, unsigned char decimalPlaces=2);
     explicit String(double, unsigned char decimalPlaces=2);
+    template <class T, uint8_t FRAC>
+    explicit String(const Fixed<T, FRAC> &value, unsigned char decimalPlaces=2)
+    {
+      init();
+      char buf[FORMAT_BUFFER_SIZE];
+      copy(buf, value.format(buf, decimalPlaces));
+    }
+    // a sum is taken only as the temporary operator + returns, since
+    // its parts point at operands that die with the statement
+    template <class L, class R>
+    String(_StringCat<L, R> &&rhs)
+    {
+      init();
+      assignSum(rhs);
+    }
+    String(const PackedString &str);  // decoded (WPackedString.cpp)
     ~String(void);
 
     // memory management
@@ -74,6 +117,12 @@ class String
     // is left unchanged).  reserve(0), if successful, will validate an
     // invalid string (i.e., "if (s)" will be true afterwards)
     unsigned char reserve(unsigned int size);
+    // exchange contents with another String; heap buffers change hands
+    // without copying
+    void swap(String &rhs);
+    // release room beyond the current length; a string that fits the
+    // inline buffer goes back to it
+    void shrink_to_fit(void);
     inline unsigned int length(void) const
     {
       return len;
@@ -84,7 +133,12 @@ class String
     // marked as invalid ("if (s)" will be false).
     String & operator = (const String &rhs);
     String & operator = (const char *cstr);
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
+    // the whole sum is measured, room made once, and each part written
+    // straight into the buffer
+    template <class L, class R>
+    String & operator = (_StringCat<L, R> &&rhs) { return assignSum(rhs); }
+    String & operator = (const PackedString &str);
+#if __cplusplus >= 201103L
     String & operator = (String && rval);
     String & operator = (StringSumHelper && rval);
 #endif
@@ -104,6 +158,16 @@ class String
     unsigned char concat(unsigned long num);
     unsigned char concat(float num);
     unsigned char concat(double num);
+    unsigned char concat(const char *cstr, unsigned int length);
+    template <class T, uint8_t FRAC>
+    unsigned char concat(const Fixed<T, FRAC> &num, unsigned char decimalPlaces=2)
+    {
+      char buf[FORMAT_BUFFER_SIZE];
+      return concat(buf, num.format(buf, decimalPlaces));
+    }
+    template <class L, class R>
+    unsigned char concat(_StringCat<L, R> &&rhs) { return concatSum(rhs); }
+    unsigned char concat(const PackedString &str);
   
     // if there's not enough memory for the concatenated value, the string
     // will be left unchanged (but this isn't signalled in any way)
@@ -157,22 +221,28 @@ class String
       concat(num);
       return (*this);
     }
-
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, const String &rhs);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, const char *cstr);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, char c);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, unsigned char num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, int num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, unsigned int num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, long num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, unsigned long num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, float num);
-    friend StringSumHelper & operator + (const StringSumHelper &lhs, double num);
+    template <class T, uint8_t FRAC>
+    String & operator += (const Fixed<T, FRAC> &num)
+    {
+      concat(num);
+      return (*this);
+    }
+    template <class L, class R>
+    String & operator += (_StringCat<L, R> &&rhs)
+    {
+      concatSum(rhs);
+      return (*this);
+    }
+    String & operator += (const PackedString &str)
+    {
+      concat(str);
+      return (*this);
+    }
 
     // comparison (only works w/ Strings and "strings")
     operator StringIfHelperType() const
     {
-      return buffer ? &String::StringIfHelper : 0;
+      return buffer() ? &String::StringIfHelper : 0;
     }
     int compareTo(const String &s) const;
     unsigned char equals(const String &s) const;
@@ -212,7 +282,7 @@ class String
     {
       getBytes((unsigned char *)buf, bufsize, index);
     }
-    const char * c_str() const { return buffer; }
+    const char * c_str() const { return buffer(); }
   
     // search
     int indexOf(char ch) const;
@@ -228,6 +298,7 @@ class String
 
     // modification
     void replace(char find, char replace);
+    // invalidates the string if the result doesn't fit in memory
     void replace(const String& find, const String& replace);
     void remove(unsigned int index);
     void remove(unsigned int index, unsigned int count);
@@ -246,27 +317,116 @@ class String
 
 
   protected:
-    char *buffer;	        // the actual char array
-    unsigned int capacity;  // the array length minus one (for the '\0')
+    // flags
+    enum {
+      STRING_HEAP = 1,       // store.buffer is on the heap
+      STRING_FIXED = 2,      // store.buffer is storage supplied by a StaticString
+      STRING_TRUNCATED = 4,  // a fixed buffer was too small for a result
+      STRING_INLINE = 8      // the characters are in inlineBuffer
+    };
+
+    // a string kept in size + 1 bytes of storage, which it never leaves
+    String(char *storage, unsigned int size);
+
+    // the characters, wherever they are kept; NULL if invalid
+    char *buffer(void) const
+    {
+      if (flags & STRING_INLINE) return const_cast<char *>(inlineBuffer);
+      return store.buffer;
+    }
+    // the array length minus one (for the '\0')
+    unsigned int capacity(void) const
+    {
+      if (flags & STRING_INLINE) return STRING_INLINE_CAPACITY;
+      return store.capacity;
+    }
+
+    // A short string is kept in inlineBuffer, over the pointer and
+    // capacity of a heap or StaticString buffer, which it doesn't need.
+    union
+    {
+      struct
+      {
+        char *buffer;           // the actual char array, NULL if invalid
+        unsigned int capacity;  // the array length minus one (for the '\0')
+      } store;
+      char inlineBuffer[STRING_INLINE_CAPACITY + 1];
+    };
     unsigned int len;       // the String length (not counting the '\0')
-    unsigned char flags;    // unused, for future features
+    unsigned char flags;
   protected:
-    void init(void);
+    void init(void)
+    {
+      store.buffer = NULL;
+      store.capacity = 0;
+      len = 0;
+      flags = 0;
+    }
     void invalidate(void);
     unsigned char changeBuffer(unsigned int maxStrLen);
-    unsigned char concat(const char *cstr, unsigned int length);
+    unsigned char grow(unsigned int maxStrLen);
+    char *extend(unsigned int maxStrLen, unsigned char slack);
+
+    // the whole of part, which has length() and write(dst, end) like
+    // the parts of a sum, measured and written straight into the buffer
+    template <class T>
+    String & assignPart(const T &part)
+    {
+      len = 0;
+      char *end = extend(part.length(), 0);
+      if (!end)
+      {
+        invalidate();
+        return *this;
+      }
+      char *b = buffer();
+      len = part.write(b, end) - b;
+      b[len] = 0;
+      return *this;
+    }
+    template <class T>
+    unsigned char concatPart(const T &part)
+    {
+      unsigned int newlen = len + part.length();
+      char *end = extend(newlen, 1);
+      if (!end) return 0;
+      char *b = buffer();
+      len = part.write(b + len, end) - b;
+      b[len] = 0;
+      return len == newlen;
+    }
+    template <class L, class R>
+    String & assignSum(const _StringCat<L, R> &sum)
+    {
+      // sum may read this string, which is about to be overwritten
+      if (!sum.uses(buffer(), len)) return assignPart(sum);
+      String tmp;
+      tmp.assignPart(sum);
+      return *this = static_cast<String &&>(tmp);
+    }
+    template <class L, class R>
+    unsigned char concatSum(const _StringCat<L, R> &sum)
+    {
+      // sum may read this string, which growing could move
+      if (!sum.uses(buffer(), len)) return concatPart(sum);
+      String tmp;
+      tmp.assignPart(sum);
+      return concat(tmp);
+    }
 
     // copy and move
     String & copy(const char *cstr, unsigned int length);
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
     void move(String &rhs);
-#endif
 };
 
 class StringSumHelper : public String
 {
   public:
     StringSumHelper(const String &s) : String(s) {}
+#if __cplusplus >= 201103L
+    // String("a") + b starts with the temporary's own buffer
+    StringSumHelper(String &&s) : String(static_cast<String &&>(s)) {}
+#endif
     StringSumHelper(const char *p) : String(p) {}
     StringSumHelper(char c) : String(c) {}
     StringSumHelper(unsigned char num) : String(num) {}
@@ -278,6 +438,296 @@ class StringSumHelper : public String
     StringSumHelper(double num) : String(num) {}
 };
 
+// String concatenation.  a + b + c is a _StringCat of its parts, which
+// are only read when the sum is assigned, appended or converted to a
+// String: the total length is summed, room made once, and each part,
+// numbers included, written straight into the buffer.  The parts refer
+// to the Strings and char * they came from, so a sum is used within
+// the statement that makes it: String takes a sum only as a temporary,
+// and auto s = a + b; leaves s pointing at operands that may be gone.
+//
+// Each part has length(), write(dst, end), which writes at most up to
+// end and returns where it stopped, and uses(buf, n), true if it reads
+// the n characters at buf.
+
+// a String or C string, by reference
+struct _StringRef
+{
+  const char *str;
+  unsigned int len;
+  unsigned int length() const { return len; }
+  char *write(char *dst, char *end) const
+  {
+    unsigned int n = end - dst;
+    if (n > len) n = len;
+    if (n) memcpy(dst, str, n);  // str is NULL for an invalid String
+    return dst + n;
+  }
+  bool uses(const char *buf, unsigned int n) const
+  {
+    return str < buf + n && str + len > buf;
+  }
+};
+
+struct _StringChar
+{
+  char c;
+  unsigned int length() const { return 1; }
+  char *write(char *dst, char *end) const
+  {
+    if (dst < end) *dst++ = c;
+    return dst;
+  }
+  bool uses(const char *, unsigned int) const { return false; }
+};
+
+// an integer in decimal, as concat(num) and String(num) write it
+struct _StringDecimal
+{
+  uint32_t magnitude;
+  bool negative;
+  _StringDecimal(uint32_t n, bool neg) : magnitude(n), negative(neg) {}
+  unsigned int length() const
+  {
+    uint8_t n = 1 + negative;
+    for (uint32_t p = 10; magnitude >= p; p *= 10)
+      if (++n == 10 + negative) break;
+    return n;
+  }
+  char *write(char *dst, char *end) const
+  {
+    char buf[11];
+    char *str = (unsigned int)(end - dst) >= length() ? dst : buf;
+    char *p = str;
+    if (negative) *p++ = '-';
+    p = _decimal(p, magnitude);
+    if (str == dst) return p;
+    return _StringRef{buf, (unsigned int)(p - buf)}.write(dst, end);
+  }
+  bool uses(const char *, unsigned int) const { return false; }
+};
+
+// float, double and Fixed are formatted when the sum is made
+struct _StringReal
+{
+  char buf[FORMAT_BUFFER_SIZE];
+  uint8_t len;
+  unsigned int length() const { return len; }
+  char *write(char *dst, char *end) const
+  {
+    return _StringRef{buf, len}.write(dst, end);
+  }
+  bool uses(const char *, unsigned int) const { return false; }
+};
+
+template <class L, class R>
+struct _StringCat
+{
+  L left;
+  R right;
+  unsigned int length() const { return left.length() + right.length(); }
+  char *write(char *dst, char *end) const
+  {
+    return right.write(left.write(dst, end), end);
+  }
+  bool uses(const char *buf, unsigned int n) const
+  {
+    return left.uses(buf, n) || right.uses(buf, n);
+  }
+};
+
+// The part each operand type becomes; these follow the concat()
+// overloads.
+inline _StringRef _stringPart(const String &s)
+{
+  return _StringRef{s.c_str(), s.length()};
+}
+inline _StringRef _stringPart(const char *cstr)
+{
+  return _StringRef{cstr, cstr ? (unsigned int)strlen(cstr) : 0};
+}
+inline _StringChar _stringPart(char c)
+{
+  return _StringChar{c};
+}
+inline _StringDecimal _stringPart(unsigned char num)
+{
+  return _StringDecimal(num, false);
+}
+inline _StringDecimal _stringPart(int num)
+{
+  return _StringDecimal(num < 0 ? 0 - (uint32_t)num : num, num < 0);
+}
+inline _StringDecimal _stringPart(unsigned int num)
+{
+  return _StringDecimal(num, false);
+}
+inline _StringDecimal _stringPart(long num)
+{
+  return _StringDecimal(num < 0 ? 0 - (uint32_t)num : num, num < 0);
+}
+inline _StringDecimal _stringPart(unsigned long num)
+{
+  return _StringDecimal(num, false);
+}
+inline _StringReal _stringPart(double num)
+{
+  _StringReal r;
+  r.len = _floatFormat(r.buf, num, 2);
+  return r;
+}
+template <class T, uint8_t FRAC>
+inline _StringReal _stringPart(const Fixed<T, FRAC> &num)
+{
+  _StringReal r;
+  r.len = num.format(r.buf, 2);
+  return r;
+}
+template <class L, class R>
+inline const _StringCat<L, R> &_stringPart(const _StringCat<L, R> &sum)
+{
+  return sum;
+}
+
+template <class T> struct _StringPlain { typedef T type; };
+template <class T> struct _StringPlain<const T &> { typedef T type; };
+
+// operator + applies when either side is a String or a sum, and both
+// sides have a _stringPart; anything else is left to other overloads
+template <class T>
+struct _StringOperand
+{
+  static char test(const String *);
+  template <class L, class R>
+  static char test(const _StringCat<L, R> *);
+  static long test(...);
+  static const bool value = sizeof(test((const T *)0)) == 1;
+};
+
+template <class A, class B, class L, class R,
+          bool = _StringOperand<A>::value || _StringOperand<B>::value>
+struct _StringSum {};
+
+template <class A, class B, class L, class R>
+struct _StringSum<A, B, L, R, true>
+{
+  typedef _StringCat<typename _StringPlain<L>::type,
+                     typename _StringPlain<R>::type> type;
+};
+
+template <class A, class B,
+          class L = decltype(_stringPart(*(const A *)0)),
+          class R = decltype(_stringPart(*(const B *)0))>
+inline typename _StringSum<A, B, L, R>::type
+operator + (const A &lhs, const B &rhs)
+{
+  typename _StringSum<A, B, L, R>::type sum = { _stringPart(lhs), _stringPart(rhs) };
+  return sum;
+}
+
+// Other String members need the sum made into one first, as in
+// String(a + b).c_str(); comparing does that itself.
+template <class L, class R, class T>
+inline unsigned char operator == (_StringCat<L, R> &&lhs, const T &rhs)
+{
+  return String(static_cast<_StringCat<L, R> &&>(lhs)) == rhs;
+}
+
+template <class L, class R, class T>
+inline unsigned char operator != (_StringCat<L, R> &&lhs, const T &rhs)
+{
+  return String(static_cast<_StringCat<L, R> &&>(lhs)) != rhs;
+}
+
+// A String of at most N characters held in the object, so it never
+// uses the heap.  Anything that doesn't fit is cut off at N characters,
+// the operation returns false and truncated() is set until cleared.
+// A StaticString is never invalid; where a String would be, it is
+// emptied instead.
+template <unsigned int N>
+class StaticString : public String
+{
+  public:
+    StaticString(const char *cstr = "") : String(storage, N)
+    {
+      if (cstr) copy(cstr, strlen(cstr));
+    }
+    StaticString(const String &str) : String(storage, N)
+    {
+      String::operator = (str);
+    }
+    StaticString(const StaticString &str) : String(storage, N)
+    {
+      copy(str.buffer(), str.len);
+    }
+    template <class L, class R>
+    StaticString(_StringCat<L, R> &&rhs) : String(storage, N)
+    {
+      assignSum(rhs);
+    }
+    StaticString(const PackedString &str) : String(storage, N)
+    {
+      String::operator = (str);
+    }
+
+    StaticString & operator = (const StaticString &rhs)
+    {
+      String::operator = (rhs);
+      return *this;
+    }
+    StaticString & operator = (const String &rhs)
+    {
+      String::operator = (rhs);
+      return *this;
+    }
+    StaticString & operator = (const char *cstr)
+    {
+      String::operator = (cstr);
+      return *this;
+    }
+    template <class L, class R>
+    StaticString & operator = (_StringCat<L, R> &&rhs)
+    {
+      assignSum(rhs);
+      return *this;
+    }
+    StaticString & operator = (const PackedString &str)
+    {
+      String::operator = (str);
+      return *this;
+    }
+
+    unsigned char truncated(void) const
+    {
+      return flags & STRING_TRUNCATED;
+    }
+    void clearTruncated(void)
+    {
+      flags &= ~STRING_TRUNCATED;
+    }
+
+    operator const char *() const
+    {
+      return buffer();
+    }
+    // so s[i] and "if (s)" don't also match the const char * conversion
+    char operator [](int index) const
+    {
+      return String::operator [](index);
+    }
+    char& operator [](int index)
+    {
+      return String::operator [](index);
+    }
+    explicit operator bool() const
+    {
+      return true;
+    }
+
+  private:
+    char storage[N + 1];
+};
+
 #endif  // __cplusplus
 #endif
 // WSTRING_H
@@ -0,0 +1,211 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | millis() and micros() timekeeping on Timer0 for
+|| | Atmel AVR 8 bit microcontroller series core.
+|| |
+|| | The overflow ISR only increments a 48-bit overflow count (28 cycles
+|| | including interrupt entry in the common case); the conversion to
+|| | milliseconds and microseconds is done by the reader.  Timer0 is
+|| | started from .init8, so it only runs when this file is linked in,
+|| | i.e. when the sketch uses millis() or micros().
+|| |
+|| | Wiring Core API
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+
+#if defined(TIMSK0)
+#define _TIMSK TIMSK0
+#define _TIFR  TIFR0
+#else
+#define _TIMSK TIMSK
+#define _TIFR  TIFR
+#endif
+
+// t13 vector name
+#if !defined(TIMER0_OVF_vect) && defined(TIM0_OVF_vect)
+#define TIMER0_OVF_vect TIM0_OVF_vect
+#endif
+
+#if TIMER0PRESCALEFACTOR == 1
+#define T0_CLOCKSELECT (_BV(CS00))
+#elif TIMER0PRESCALEFACTOR == 8
+#define T0_CLOCKSELECT (_BV(CS01))
+#elif TIMER0PRESCALEFACTOR == 64
+#define T0_CLOCKSELECT (_BV(CS01) | _BV(CS00))
+#elif TIMER0PRESCALEFACTOR == 256
+#define T0_CLOCKSELECT (_BV(CS02))
+#elif TIMER0PRESCALEFACTOR == 1024
+#define T0_CLOCKSELECT (_BV(CS02) | _BV(CS00))
+#else
+#error "TIMER0PRESCALEFACTOR must be 1, 8, 64, 256 or 1024"
+#endif
+
+// Microseconds per timer tick and milliseconds per overflow in 16.16
+// fixed point, both rounded.  Exact for power-of-two MHz clocks, and
+// within 6 ppm for 12, 18.432 and 20 MHz.
+#define US_PER_TICK_Q16 \
+        (((uint64_t)TIMER0PRESCALEFACTOR * 1000000 * 65536 + F_CPU / 2) / F_CPU)
+#define MS_PER_OVF_Q16 \
+        (((uint64_t)TIMER0PRESCALEFACTOR * 256 * 1000 * 65536 + F_CPU / 2) / F_CPU)
+
+static const uint16_t usPerTick = US_PER_TICK_Q16 >> 16;
+static const uint16_t usPerTickFrac = US_PER_TICK_Q16 & 0xFFFF;
+static const uint16_t msPerOvf = MS_PER_OVF_Q16 >> 16;
+static const uint16_t msPerOvfFrac = MS_PER_OVF_Q16 & 0xFFFF;
+
+// The overflow count is 48 bits so that millis() and micros() wrap
+// modulo 2^32 like a plain counter: 2^48 overflows times a 16 bit
+// fraction is a whole multiple of 2^32, where a 32 bit count would
+// wrap after about 50 days with millis() part way round.
+struct _Timer0Count
+{
+  uint32_t low;
+  uint16_t high;
+};
+
+volatile _Timer0Count timer0Overflows;
+
+
+// Start Timer0 in normal mode with the overflow interrupt enabled.
+// Runs after the static constructors and before main().
+static void timer0Init(void) __attribute__((naked, used, section(".init8")));
+static void timer0Init(void)
+{
+  TCCR0B = T0_CLOCKSELECT;
+  _TIMSK |= _BV(TOIE0);
+  sei();
+}
+
+
+#if defined(__AVR__)
+// 48-bit increment touching only r24 and SREG.  subi 0xFF adds 1 and
+// leaves carry set unless the byte wrapped, so the upper bytes are
+// only loaded once every 256 overflows.
+ISR(TIMER0_OVF_vect, ISR_NAKED)
+{
+  asm volatile (
+    "push r24"              "\n\t"
+    "in r24, __SREG__"      "\n\t"
+    "push r24"              "\n\t"
+    "lds r24, %0"           "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0, r24"           "\n\t"
+    "brcs 1f"               "\n\t"
+    "lds r24, %0+1"         "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0+1, r24"         "\n\t"
+    "brcs 1f"               "\n\t"
+    "lds r24, %0+2"         "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0+2, r24"         "\n\t"
+    "brcs 1f"               "\n\t"
+    "lds r24, %0+3"         "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0+3, r24"         "\n\t"
+    "brcs 1f"               "\n\t"
+    "lds r24, %0+4"         "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0+4, r24"         "\n\t"
+    "brcs 1f"               "\n\t"
+    "lds r24, %0+5"         "\n\t"
+    "subi r24, 0xFF"        "\n\t"
+    "sts %0+5, r24"         "\n\t"
+    "1: pop r24"            "\n\t"
+    "out __SREG__, r24"     "\n\t"
+    "pop r24"               "\n\t"
+    "reti"
+    :: "i" (&timer0Overflows)
+  );
+}
+#else
+// the same increment in C, for host builds
+ISR(TIMER0_OVF_vect)
+{
+  if (++timer0Overflows.low == 0) timer0Overflows.high++;
+}
+#endif
+
+
+// Atomic snapshot of the overflow count and TCNT0, including an
+// overflow that is pending because interrupts are disabled.  Returns
+// the low 32 bits of the count and sets *high to the rest.
+static uint32_t timer0Read(uint8_t *tcnt, uint16_t *high)
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t ovf = timer0Overflows.low;
+  uint16_t hi = timer0Overflows.high;
+  uint8_t t = TCNT0;
+  if ((_TIFR & _BV(TOV0)) && (t < 255))
+  {
+    if (++ovf == 0) hi++;
+  }
+  SREG = sreg;
+
+  *tcnt = t;
+  *high = hi;
+  return ovf;
+}
+
+
+uint32_t millis(void)
+{
+  uint8_t t;
+  uint16_t hi;
+  uint32_t ovf = timer0Read(&t, &hi);
+
+  // ovf * msPerOvf.msPerOvfFrac modulo 2^32, split so no product
+  // exceeds 32 bits; the count's bits 16-47 carry the fraction
+  uint32_t ms = ovf * msPerOvf;
+  if (msPerOvfFrac)
+  {
+    ms += (((uint32_t)hi << 16) | (ovf >> 16)) * msPerOvfFrac;
+    ms += ((ovf & 0xFFFF) * msPerOvfFrac) >> 16;
+  }
+  return ms;
+}
+
+
+uint32_t micros(void)
+{
+  uint8_t t;
+  uint16_t hi;
+  uint32_t ovf = timer0Read(&t, &hi);
+  uint32_t ticks = (ovf << 8) | t;
+
+  // ticks * usPerTick.usPerTickFrac modulo 2^32, as in millis(); the
+  // tick count is the overflow count shifted left 8
+  uint32_t us = ticks * usPerTick;
+  if (usPerTickFrac)
+  {
+    us += (((uint32_t)hi << 24) | (ovf >> 8)) * usPerTickFrac;
+    us += ((((ovf & 0xFF) << 8) | t) * (uint32_t)usPerTickFrac) >> 16;
+  }
+  return us;
+}
+
+
+// Overrides the busy-wait delay() in main.cpp whenever this file is
+// linked.  Time spent in interrupt handlers counts toward the delay
+// instead of adding to it; interrupts must be enabled.
+void delay(uint16_t ms)
+{
+  uint32_t start = micros();
+  while (ms)
+  {
+    if (micros() - start >= 1000)
+    {
+      ms--;
+      start += 1000;
+    }
+  }
+}
@@ -0,0 +1,103 @@
+/*
+||
+|| @author         Ralph Doncaster - ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Board Specific Definitions for:
+|| |   8-pin ATtiny13(A) and ATtiny25/45/85.
+|| |   (Atmel AVR 8 bit microcontroller core)
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+|| Digital pin N is PBN.  There is no USART; Serial is bit-banged on
+|| TX0/RX0 (see WSoftSerial.h), and SPI uses the USI on t25/45/85.
+*/
+
+#ifndef WBOARDDEFS_H
+#define WBOARDDEFS_H
+
+#include "WConstants.h"
+
+#define TOTAL_PINS              6
+#define TOTAL_ANALOG_PINS       4
+
+// How many ports are on this device
+#define WIRING_PORTS 1
+
+/*************************************************************
+ * Prototypes
+ *************************************************************/
+
+void boardInit(void);
+
+
+/*************************************************************
+ * Pin locations - constants
+ *************************************************************/
+
+// SPI (USI three-wire mode)
+const static uint8_t MOSI = 1;  // DO
+const static uint8_t MISO = 0;  // DI
+const static uint8_t SCK  = 2;  // USCK
+
+// TWI (USI two-wire mode)
+const static uint8_t SCL  = 2;
+const static uint8_t SDA  = 0;
+
+// Analog pins (ADC channels); ADC0 is on PB5, the reset pin
+const static uint8_t A0 = 0;    // PB5
+const static uint8_t A1 = 1;    // PB2
+const static uint8_t A2 = 2;    // PB4
+const static uint8_t A3 = 3;    // PB3
+
+// External Interrupts
+const static uint8_t EI0 = 2;
+
+// Bit-banged serial port pins; PB3/PB4 leave the ISP pins free
+#ifndef SOFTSERIAL_TX
+#define SOFTSERIAL_TX 3
+#endif
+#ifndef SOFTSERIAL_RX
+#define SOFTSERIAL_RX 4
+#endif
+const static uint8_t RX0 = SOFTSERIAL_RX;
+const static uint8_t TX0 = SOFTSERIAL_TX;
+
+
+/*************************************************************
+ * Pin to register mapping
+ *************************************************************/
+
+#define WIRING_PORT_REGS PINB
+
+#define WIRING_PIN_MAP \
+        WPIN(0, 0), WPIN(0, 1), WPIN(0, 2), \
+        WPIN(0, 3), WPIN(0, 4), WPIN(0, 5)
+
+#include "WBoard.h"
+
+#if defined(OCR1B)
+// t25/45/85: OC1A shares PB1 with OC0B
+#define digitalPinToTimer(PIN) \
+        ( ((PIN) == 0) ? TIMER0A : \
+        ( ((PIN) == 1) ? TIMER0B : \
+        ( ((PIN) == 4) ? TIMER1B : NOT_A_TIMER)))
+#else
+#define digitalPinToTimer(PIN) \
+        ( ((PIN) == 0) ? TIMER0A : \
+        ( ((PIN) == 1) ? TIMER0B : NOT_A_TIMER))
+#endif
+
+#define pinToInterrupt(PIN) \
+        ( ((PIN) == 2) ? EXTERNAL_INTERRUPT_0 : -1)
+
+/*************************************************************
+ * Timer prescale factors
+ *************************************************************/
+
+#define TIMER0PRESCALEFACTOR 64
+
+#endif
+// BOARDDEFS_H
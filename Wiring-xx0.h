@@ -0,0 +1,173 @@
+/*
+||
+|| @author         Ralph Doncaster - ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Board Specific Definitions for:
+|| |   Arduino Mega and all
+|| |   ATmega640/1280/2560 Arduino compatible boards.
+|| |   (Atmel AVR 8 bit microcontroller core)
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+|| PORTH-PORTL are outside the sbi/cbi range, so writes to pins on
+|| those ports are done as an interrupt-safe read-modify-write.
+*/
+
+#ifndef WBOARDDEFS_H
+#define WBOARDDEFS_H
+
+#include "WConstants.h"
+
+#define TOTAL_PINS              70
+#define TOTAL_ANALOG_PINS       16
+#define FIRST_ANALOG_PIN        54
+
+#define WLED                    13
+
+// How many ports are on this device
+#define WIRING_PORTS 11
+
+/*************************************************************
+ * Prototypes
+ *************************************************************/
+
+void boardInit(void);
+
+
+/*************************************************************
+ * Pin locations - constants
+ *************************************************************/
+
+// SPI port
+const static uint8_t SS   = 53;
+const static uint8_t MOSI = 51;
+const static uint8_t MISO = 50;
+const static uint8_t SCK  = 52;
+
+// TWI port
+const static uint8_t SCL  = 21;
+const static uint8_t SDA  = 20;
+
+// Analog pins
+const static uint8_t A0 = 0;
+const static uint8_t A1 = 1;
+const static uint8_t A2 = 2;
+const static uint8_t A3 = 3;
+const static uint8_t A4 = 4;
+const static uint8_t A5 = 5;
+const static uint8_t A6 = 6;
+const static uint8_t A7 = 7;
+const static uint8_t A8 = 8;
+const static uint8_t A9 = 9;
+const static uint8_t A10 = 10;
+const static uint8_t A11 = 11;
+const static uint8_t A12 = 12;
+const static uint8_t A13 = 13;
+const static uint8_t A14 = 14;
+const static uint8_t A15 = 15;
+
+// External Interrupts
+const static uint8_t EI0 = 21;
+const static uint8_t EI1 = 20;
+const static uint8_t EI2 = 19;
+const static uint8_t EI3 = 18;
+const static uint8_t EI4 = 2;
+const static uint8_t EI5 = 3;
+
+// Hardware Serial port pins
+const static uint8_t RX0 = 0;
+const static uint8_t TX0 = 1;
+const static uint8_t RX1 = 19;
+const static uint8_t TX1 = 18;
+const static uint8_t RX2 = 17;
+const static uint8_t TX2 = 16;
+const static uint8_t RX3 = 15;
+const static uint8_t TX3 = 14;
+
+
+/*************************************************************
+ * Pin to register mapping
+ *************************************************************/
+
+// port numbers
+#define WPORT_A 0
+#define WPORT_B 1
+#define WPORT_C 2
+#define WPORT_D 3
+#define WPORT_E 4
+#define WPORT_F 5
+#define WPORT_G 6
+#define WPORT_H 7
+#define WPORT_J 8
+#define WPORT_K 9
+#define WPORT_L 10
+
+#define WIRING_PORT_REGS \
+        PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL
+
+#define WIRING_PIN_MAP \
+        WPIN(WPORT_E, 0), WPIN(WPORT_E, 1),        /* D0-D1   */ \
+        WPIN(WPORT_E, 4), WPIN(WPORT_E, 5),        /* D2-D3   */ \
+        WPIN(WPORT_G, 5), WPIN(WPORT_E, 3),        /* D4-D5   */ \
+        WPIN(WPORT_H, 3), WPIN(WPORT_H, 4),        /* D6-D7   */ \
+        WPIN(WPORT_H, 5), WPIN(WPORT_H, 6),        /* D8-D9   */ \
+        WPIN(WPORT_B, 4), WPIN(WPORT_B, 5),        /* D10-D11 */ \
+        WPIN(WPORT_B, 6), WPIN(WPORT_B, 7),        /* D12-D13 */ \
+        WPIN(WPORT_J, 1), WPIN(WPORT_J, 0),        /* D14-D15 */ \
+        WPIN(WPORT_H, 1), WPIN(WPORT_H, 0),        /* D16-D17 */ \
+        WPIN(WPORT_D, 3), WPIN(WPORT_D, 2),        /* D18-D19 */ \
+        WPIN(WPORT_D, 1), WPIN(WPORT_D, 0),        /* D20-D21 */ \
+        WPORT_PINS(WPORT_A),                       /* D22-D29 */ \
+        WPIN(WPORT_C, 7), WPIN(WPORT_C, 6),        /* D30-D31 */ \
+        WPIN(WPORT_C, 5), WPIN(WPORT_C, 4),        /* D32-D33 */ \
+        WPIN(WPORT_C, 3), WPIN(WPORT_C, 2),        /* D34-D35 */ \
+        WPIN(WPORT_C, 1), WPIN(WPORT_C, 0),        /* D36-D37 */ \
+        WPIN(WPORT_D, 7), WPIN(WPORT_G, 2),        /* D38-D39 */ \
+        WPIN(WPORT_G, 1), WPIN(WPORT_G, 0),        /* D40-D41 */ \
+        WPIN(WPORT_L, 7), WPIN(WPORT_L, 6),        /* D42-D43 */ \
+        WPIN(WPORT_L, 5), WPIN(WPORT_L, 4),        /* D44-D45 */ \
+        WPIN(WPORT_L, 3), WPIN(WPORT_L, 2),        /* D46-D47 */ \
+        WPIN(WPORT_L, 1), WPIN(WPORT_L, 0),        /* D48-D49 */ \
+        WPIN(WPORT_B, 3), WPIN(WPORT_B, 2),        /* D50-D51 */ \
+        WPIN(WPORT_B, 1), WPIN(WPORT_B, 0),        /* D52-D53 */ \
+        WPORT_PINS(WPORT_F),                       /* D54-D61 */ \
+        WPORT_PINS(WPORT_K)                        /* D62-D69 */
+
+#include "WBoard.h"
+
+#define digitalPinToTimer(PIN) \
+        ( ((PIN) == 2) ? TIMER3B : \
+        ( ((PIN) == 3) ? TIMER3C : \
+        ( ((PIN) == 4) ? TIMER0B : \
+        ( ((PIN) == 5) ? TIMER3A : \
+        ( ((PIN) == 6) ? TIMER4A : \
+        ( ((PIN) == 7) ? TIMER4B : \
+        ( ((PIN) == 8) ? TIMER4C : \
+        ( ((PIN) == 9) ? TIMER2B : \
+        ( ((PIN) == 10) ? TIMER2A : \
+        ( ((PIN) == 11) ? TIMER1A : \
+        ( ((PIN) == 12) ? TIMER1B : \
+        ( ((PIN) == 13) ? TIMER0A : \
+        ( ((PIN) == 44) ? TIMER5C : \
+        ( ((PIN) == 45) ? TIMER5B : \
+        ( ((PIN) == 46) ? TIMER5A : NOT_A_TIMER)))))))))))))))
+
+#define pinToInterrupt(PIN) \
+        ( ((PIN) == 21) ? EXTERNAL_INTERRUPT_0 : \
+        ( ((PIN) == 20) ? EXTERNAL_INTERRUPT_1 : \
+        ( ((PIN) == 19) ? EXTERNAL_INTERRUPT_2 : \
+        ( ((PIN) == 18) ? EXTERNAL_INTERRUPT_3 : \
+        ( ((PIN) == 2) ? EXTERNAL_INTERRUPT_4 : \
+        ( ((PIN) == 3) ? EXTERNAL_INTERRUPT_5 : -1))))))
+
+/*************************************************************
+ * Timer prescale factors
+ *************************************************************/
+
+#define TIMER0PRESCALEFACTOR 64
+
+#endif
+// BOARDDEFS_H
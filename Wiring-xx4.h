@@ -0,0 +1,109 @@
+/*
+||
+|| @author         Ralph Doncaster - ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Board Specific Definitions for:
+|| |   40-pin ATmega164/324/644/1284(P) boards, "standard" pinout
+|| |   (D0-D7 PORTB, D8-D15 PORTD, D16-D23 PORTC, D24-D31 PORTA).
+|| |   (Atmel AVR 8 bit microcontroller core)
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef WBOARDDEFS_H
+#define WBOARDDEFS_H
+
+#include "WConstants.h"
+
+#define TOTAL_PINS              32
+#define TOTAL_ANALOG_PINS       8
+#define FIRST_ANALOG_PIN        24
+
+// How many ports are on this device
+#define WIRING_PORTS 4
+
+/*************************************************************
+ * Prototypes
+ *************************************************************/
+
+void boardInit(void);
+
+
+/*************************************************************
+ * Pin locations - constants
+ *************************************************************/
+
+// SPI port
+const static uint8_t SS   = 4;
+const static uint8_t MOSI = 5;
+const static uint8_t MISO = 6;
+const static uint8_t SCK  = 7;
+
+// TWI port
+const static uint8_t SCL  = 16;
+const static uint8_t SDA  = 17;
+
+// Analog pins
+const static uint8_t A0 = 0;
+const static uint8_t A1 = 1;
+const static uint8_t A2 = 2;
+const static uint8_t A3 = 3;
+const static uint8_t A4 = 4;
+const static uint8_t A5 = 5;
+const static uint8_t A6 = 6;
+const static uint8_t A7 = 7;
+
+// External Interrupts
+const static uint8_t EI0 = 10;
+const static uint8_t EI1 = 11;
+const static uint8_t EI2 = 2;
+
+// Hardware Serial port pins
+const static uint8_t RX0 = 8;
+const static uint8_t TX0 = 9;
+const static uint8_t RX1 = 10;
+const static uint8_t TX1 = 11;
+
+
+/*************************************************************
+ * Pin to register mapping
+ *************************************************************/
+
+#define WIRING_PORT_REGS PINB, PIND, PINC, PINA
+
+#define WIRING_PIN_MAP \
+        WPORT_PINS(0),                             /* D0-D7:   PORTB */ \
+        WPORT_PINS(1),                             /* D8-D15:  PORTD */ \
+        WPORT_PINS(2),                             /* D16-D23: PORTC */ \
+        WPORT_PINS(3)                              /* D24-D31: PORTA */
+
+#include "WBoard.h"
+
+// timer 3 is only on the m1284
+#define digitalPinToTimer(PIN) \
+        ( ((PIN) == 3) ? TIMER0A : \
+        ( ((PIN) == 4) ? TIMER0B : \
+        ( ((PIN) == 6) ? TIMER3A : \
+        ( ((PIN) == 7) ? TIMER3B : \
+        ( ((PIN) == 12) ? TIMER1B : \
+        ( ((PIN) == 13) ? TIMER1A : \
+        ( ((PIN) == 14) ? TIMER2B : \
+        ( ((PIN) == 15) ? TIMER2A : NOT_A_TIMER))))))))
+
+#define pinToInterrupt(PIN) \
+        ( ((PIN) == 10) ? EXTERNAL_INTERRUPT_0 : \
+        ( ((PIN) == 11) ? EXTERNAL_INTERRUPT_1 : \
+        ( ((PIN) == 2) ? EXTERNAL_INTERRUPT_2 : -1)))
+
+/*************************************************************
+ * Timer prescale factors
+ *************************************************************/
+
+#define TIMER0PRESCALEFACTOR 64
+
+#endif
+// BOARDDEFS_H
@@ -69,25 +69,19 @@ const static uint8_t TX0 = 1;
 
 
 /*************************************************************
- * Pin to register mapping macros
+ * Pin to register mapping
  *************************************************************/
 
-#define digitalPinToPortReg(PIN) \
-        ( ((PIN) >= 0  && (PIN) <= 7)  ? &PORTD : \
-        ( ((PIN) >= 8  && (PIN) <= 13) ? &PORTB : \
-        ( ((PIN) >= 14 && (PIN) <= 19) ? &PORTC : NOT_A_REG)))
+#define WIRING_PORT_REGS PIND, PINB, PINC
 
-#define digitalPinToBit(PIN) \
-        ( ((PIN) >= 0  && (PIN) <= 7)  ? ((PIN)) : \
-        ( ((PIN) >= 8  && (PIN) <= 13) ? ((PIN) - 8) : \
-        ( ((PIN) >= 14 && (PIN) <= 19) ? ((PIN) - 14) : 0)))
+#define WIRING_PIN_MAP \
+        WPORT_PINS(0),                             /* D0-D7:   PORTD */ \
+        WPIN(1, 0), WPIN(1, 1), WPIN(1, 2),        /* D8-D13:  PORTB */ \
+        WPIN(1, 3), WPIN(1, 4), WPIN(1, 5), \
+        WPIN(2, 0), WPIN(2, 1), WPIN(2, 2),        /* D14-D19: PORTC */ \
+        WPIN(2, 3), WPIN(2, 4), WPIN(2, 5)
 
-#define digitalPinToBitMask(PIN) (1 << (digitalPinToBit(PIN)))
-
-#define digitalPinToPort(PIN) \
-        ( ((PIN) >= 0  && (PIN) <= 7)  ? 0 : \
-        ( ((PIN) >= 8  && (PIN) <= 13) ? 1 : \
-        ( ((PIN) >= 14 && (PIN) <= 19) ? 2 : NOT_A_PORT)))
+#include "WBoard.h"
 
 #define digitalPinToTimer(PIN) \
         ( ((PIN) == 3) ? TIMER2B : \
@@ -97,21 +91,6 @@ const static uint8_t TX0 = 1;
         ( ((PIN) == 10) ? TIMER1B : \
         ( ((PIN) == 11) ? TIMER2A : NOT_A_TIMER))))))
 
-#define portOutputRegister(PORT) \
-        ( ((PORT) == 0 ) ? &PORTD : \
-        ( ((PORT) == 1 ) ? &PORTB : \
-        ( ((PORT) == 2 ) ? &PORTC : NOT_A_REG)))
-
-#define portInputRegister(PORT) \
-        ( ((PORT) == 0 ) ? &PIND : \
-        ( ((PORT) == 1 ) ? &PINB : \
-        ( ((PORT) == 2 ) ? &PINC : NOT_A_REG)))
-
-#define portModeRegister(PORT) \
-        ( ((PORT) == 0 ) ? &DDRD : \
-        ( ((PORT) == 1 ) ? &DDRB : \
-        ( ((PORT) == 2 ) ? &DDRC : NOT_A_REG)))
-
 #define pinToInterrupt(PIN) \
         ( ((PIN) == 2) ? EXTERNAL_INTERRUPT_0 : \
         ( ((PIN) == 3) ? EXTERNAL_INTERRUPT_1 : -1))
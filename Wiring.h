@@ -28,15 +28,28 @@
 #define NOT_A_REG  0
 #define NOT_A_PORT 0xFF
 
-#if defined(PORTC)
+#if defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) || \
+    defined(__AVR_ATmega2560__)
+#include "Wiring-xx0.h"
+#elif defined(__AVR_ATmega164A__) || defined(__AVR_ATmega164P__) || \
+      defined(__AVR_ATmega324A__) || defined(__AVR_ATmega324P__) || \
+      defined(__AVR_ATmega324PA__) || defined(__AVR_ATmega644__) || \
+      defined(__AVR_ATmega644A__) || defined(__AVR_ATmega644P__) || \
+      defined(__AVR_ATmega644PA__) || defined(__AVR_ATmega1284__) || \
+      defined(__AVR_ATmega1284P__)
+#include "Wiring-xx4.h"
+#elif defined(PORTC)
 // m88/168/328 and t48/88
 #include "Wiring-xx8.h"
 #elif defined(PORTB) && !defined(PORTA)
 // 8-pin t13 and tinyx5
+#include "Wiring-tinyx5.h"
 #endif
 
+#include <WPin.h>
 #include <WHardwareSerial.h>
 #include <WMath.h>
+#include <PrintBuffer.h>
 
 #define digitalWrite(PIN, VALUE) pinWrite(PIN, VALUE)
 #define digitalRead(PIN) pinRead(PIN)
@@ -51,19 +64,56 @@ void _portMode(uint8_t, uint8_t);
 uint8_t _portRead(uint8_t);
 void _portWrite(uint8_t, uint8_t);
 
+// Set or clear bits of a constant register address.  Registers in the
+// sbi/cbi range need nothing else; above it (PORTH-PORTL on the m2560)
+// the read-modify-write is done with interrupts disabled.
+static inline void _regWrite(volatile uint8_t *, uint8_t, uint8_t) __attribute__((always_inline, unused));
+static inline void _regWrite(volatile uint8_t *REG, uint8_t MASK, uint8_t VALUE)
+{
+    uint8_t sreg = 0;
+    uint8_t atomic = _SFR_MEM_ADDR(*REG) >= 0x40;
+    if (atomic)
+    {
+      sreg = SREG;
+      cli();
+    }
+    if (VALUE)
+      *REG |= MASK;
+    else
+      *REG &= ~MASK;
+    if (atomic) SREG = sreg;
+}
+
 static inline void pinMode(uint8_t, uint8_t) __attribute__((always_inline, unused));
 static inline void pinMode(uint8_t PIN, uint8_t MODE)
 {
-    if (MODE)
-      *(portModeRegister(digitalPinToPort(PIN))) |= digitalPinToBitMask(PIN);
-    else
-      *(portModeRegister(digitalPinToPort(PIN))) &= ~digitalPinToBitMask(PIN);  
+    // runtime pin numbers use the flash lookup tables in WDigital.cpp
+    if (!__builtin_constant_p(PIN))
+    {
+      _pinMode(PIN, MODE);
+      return;
+    }
+
+    // PORTx is set up before DDRx is cleared so the pin never floats.
+    // INPUT turns the pull-up off, as in Arduino, but only once DDRx is
+    // cleared so that an output that was high is never driven low.
+    if (MODE == INPUT_PULLUP || MODE == OUTPUT_OPEN_DRAIN)
+      _regWrite(digitalPinToPortReg(PIN), digitalPinToBitMask(PIN),
+                MODE == INPUT_PULLUP);
+
+    _regWrite(portModeRegister(digitalPinToPort(PIN)),
+              digitalPinToBitMask(PIN), MODE == OUTPUT);
+
+    if (MODE == INPUT)
+      _regWrite(digitalPinToPortReg(PIN), digitalPinToBitMask(PIN), LOW);
 }
 
 
 static inline uint8_t pinRead(uint8_t) __attribute__((always_inline, unused));
 static inline uint8_t pinRead(uint8_t PIN)
 {
+    if (!__builtin_constant_p(PIN))
+      return _pinRead(PIN);
     return (*(portInputRegister(digitalPinToPort(PIN))) & digitalPinToBitMask(PIN)) ? HIGH : LOW;
 }
 
@@ -74,17 +124,57 @@ static inline uint8_t pinRead(uint8_t PIN)
 static inline void pinWrite(uint8_t, uint8_t) __attribute__((always_inline, unused));
 static inline void pinWrite(uint8_t PIN, uint8_t VALUE)
 {
-    if (VALUE)
-    {
-      *(digitalPinToPortReg(PIN)) |= digitalPinToBitMask(PIN);
-    }
+    if (!__builtin_constant_p(PIN))
+      _pinWrite(PIN, VALUE);
     else
-    {
-      *(digitalPinToPortReg(PIN)) &= ~digitalPinToBitMask(PIN);  
-    }
+      _regWrite(digitalPinToPortReg(PIN), digitalPinToBitMask(PIN), VALUE);
+}
+
+// For pins in OUTPUT_OPEN_DRAIN mode: LOW drives the pin low, HIGH
+// releases it.  DDRx is switched and PORTx stays 0, so with a constant
+// pin this is also a single sbi/cbi.
+static inline void openDrainWrite(uint8_t, uint8_t) __attribute__((always_inline, unused));
+static inline void openDrainWrite(uint8_t PIN, uint8_t VALUE)
+{
+    if (!__builtin_constant_p(PIN))
+      _pinMode(PIN, VALUE ? INPUT : OUTPUT);
+    else
+      _regWrite(portModeRegister(digitalPinToPort(PIN)),
+                digitalPinToBitMask(PIN), !VALUE);
 }
 
 void delay(uint16_t millisecs);
+void _delayMicroseconds(uint16_t);
+
+// Cycle-exact for a constant argument; a runtime argument goes to a
+// loop that takes its own call overhead out of the delay, so very
+// short runtime delays return immediately.
+static inline void delayMicroseconds(uint16_t) __attribute__((always_inline, unused));
+static inline void delayMicroseconds(uint16_t us)
+{
+    if (__builtin_constant_p(us))
+      __builtin_avr_delay_cycles(F_CPU / 1000 * us / 1000);
+    else
+      _delayMicroseconds(us);
+}
+
+// Timer0 timebase (WTime.cpp); both wrap modulo 2^32
+uint32_t millis(void);
+uint32_t micros(void);
+
+// Time elapsed since an earlier millis()/micros() value, correct
+// across counter wraparound
+static inline uint32_t millisSince(uint32_t start) __attribute__((always_inline, unused));
+static inline uint32_t millisSince(uint32_t start)
+{
+    return millis() - start;
+}
+
+static inline uint32_t microsSince(uint32_t start) __attribute__((always_inline, unused));
+static inline uint32_t microsSince(uint32_t start)
+{
+    return micros() - start;
+}
 
 // main program prototypes
 void setup(void);
@@ -1,10 +1,40 @@
 #include <Wiring.h>
 
-#include <util/delay.h>
+#include <util/delay_basic.h>
 
+// _delay_loop_2 passes (4 cycles each) per microsecond, 8.8 fixed point
+#define LOOPS_PER_US_Q8 ((F_CPU * 64 + 500000) / 1000000)
+
+// cycles of a runtime delayMicroseconds() outside of the delay loop:
+// call, loop count calculation and return
+#if defined(__AVR_HAVE_MUL__)
+#define DELAYUS_OVERHEAD 28
+#else
+#define DELAYUS_OVERHEAD 48
+#endif
+
+void _delayMicroseconds(uint16_t us)
+{
+  uint32_t loops = ((uint32_t)us * (uint16_t)LOOPS_PER_US_Q8) >> 8;
+  if ( loops <= DELAYUS_OVERHEAD / 4 ) return;
+  loops -= DELAYUS_OVERHEAD / 4;
+
+  // a count of 0 is 65536 passes
+  while ( loops > 0xFFFF )
+  {
+    _delay_loop_2(0);
+    loops -= 0x10000;
+  }
+  if ( loops ) _delay_loop_2(loops);
+}
+
+// Busy-wait delay, replaced by the timer-based one in WTime.cpp when
+// millis() or micros() is used.  The 4 cycles of loop overhead are
+// taken out of each millisecond so long delays don't drift.
+void delay(uint16_t ms) __attribute__((weak));
 void delay(uint16_t ms)
 {
-  while ( ms-- ) _delay_ms(1);
+  while ( ms-- ) __builtin_avr_delay_cycles(F_CPU / 1000 - 4);
 }
 
 int main(void) 
@@ -0,0 +1,76 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | A simulated 24 hours of a command parser handling one command a
+|| | second: read the line with +=, trim it, split it with substring(),
+|| | toInt() the value and build a reply with +.  Reports the String
+|| | heap traffic and fragmentation on the 1 KB first-fit heap.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include <stdio.h>
+
+static unsigned long seed = 12345;
+static unsigned int pick(unsigned int n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+static const char *commands[] = { "get", "set", "status", "log", "cal", "help", "echo" };
+static const char *names[] = { "rate", "temp", "gain", "offset", "mode", "threshold",
+                               "hysteresis", "channel" };
+
+String deviceName("logger-01");   // long-lived
+String lastReply;                 // long-lived, reassigned each command
+
+int main()
+{
+  size_t worstFragments = 0, worstLargest = 100000;
+  for (long t = 0; t < 86400L; t++)
+  {
+    // the command line as received over serial
+    char line[48];
+    int k = snprintf(line, sizeof(line), "  %s %s %ld\n", commands[pick(7)],
+                     names[pick(8)], (long)pick(30000) - 1000);
+    String input;
+    for (int i = 0; i < k && line[i] != '\n'; i++) input += line[i];
+    input.trim();
+    int space = input.indexOf(' ');
+    String command = input.substring(0, space);
+    String args = input.substring(space + 1);
+    int space2 = args.indexOf(' ');
+    String name = args.substring(0, space2);
+    long value = args.substring(space2 + 1).toInt();
+    String reply = String("OK ") + command + ' ' + name + '=' + value;
+    if (command == "status")
+    {
+      reply += " up ";
+      reply += t;
+      reply += "s on ";
+      reply += deviceName;
+    }
+    if (pick(1000) == 0) deviceName = String("logger-") + (long)pick(100) + "-" + name;
+    lastReply = reply;
+
+    size_t largest, fragments = heapFragments(&largest);
+    if (fragments > worstFragments) worstFragments = fragments;
+    if (largest < worstLargest) worstLargest = largest;
+  }
+
+  size_t largest, fragments = heapFragments(&largest);
+  printf("sizeof(String)=%u malloc=%lu realloc=%lu free=%lu fail=%lu copied=%lu\n"
+         "peak_heap=%u peak_in_use=%u worst_free_fragments=%u worst_largest_free=%u"
+         " end_fragments=%u\n",
+         (unsigned)sizeof(String), heapMallocs, heapReallocs, heapFrees, heapFailures,
+         heapCopied, (unsigned)heapPeak, (unsigned)heapPeakInUse,
+         (unsigned)worstFragments, (unsigned)worstLargest, (unsigned)fragments);
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Heap calls made by the common ways a String changes hands:
+|| | substring(), returning and assigning Strings, a chain of +,
+|| | swapping two heap strings and readStringUntil().
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include <stdio.h>
+
+static const char *source;
+
+class LineStream : public Stream
+{
+  public:
+    LineStream() : Stream(&sink, &read) {}
+  private:
+    static size_t sink(Print &, const uint8_t *, size_t size) { return size; }
+    static int read(Stream &) { return *source ? (uint8_t)*source++ : -1; }
+    // the source as it takes a request, which is only ever to read
+    template <class Request>
+    static int read(Stream &s, Request) { return read(s); }
+};
+
+static void report(const char *what)
+{
+  printf("%-34s malloc=%3lu realloc=%3lu free=%3lu copied=%4lu\n", what,
+         heapMallocs, heapReallocs, heapFrees, heapCopied);
+  heapResetCounts();
+}
+
+static String name(int i)
+{
+  String s("sensor-channel-");
+  s += i;
+  return s;
+}
+
+int main()
+{
+  String line("temperature=21.5;humidity=40;pressure=1013");
+  report("setup");
+  for (int i = 0; i < 10; i++) String f = line.substring(0, 16);
+  report("10x substring() into String");
+  for (int i = 0; i < 10; i++) String n = name(i);
+  report("10x String returned by function");
+  String a;
+  for (int i = 0; i < 10; i++) a = name(i);
+  report("10x assign returned String");
+  for (int i = 0; i < 10; i++)
+    String r = String("value-of-the-key") + ":" + i + "," + line;
+  report("10x String(..) + ... chain");
+  String b("another long string on the heap");
+  for (int i = 0; i < 10; i++)
+  {
+    String t(a);
+    a = b;
+    b = t;
+  }
+  report("10x swap via copies");
+#ifdef HAVE_SWAP
+  for (int i = 0; i < 10; i++) a.swap(b);
+  report("10x swap()");
+#endif
+  LineStream stream;
+  for (int i = 0; i < 10; i++)
+  {
+    source = "a line read from the serial port, 40 chars\n";
+    String l = stream.readStringUntil('\n');
+  }
+  report("10x readStringUntil()");
+  return 0;
+}
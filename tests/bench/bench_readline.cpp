@@ -0,0 +1,46 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | readStringUntil() of a 200 character line from a Stream, with the
+|| | heap calls and peak heap it takes.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include <stdio.h>
+
+static const char *source;
+
+class LineStream : public Stream
+{
+  public:
+    LineStream() : Stream(&sink, &read) {}
+  private:
+    static size_t sink(Print &, const uint8_t *, size_t size) { return size; }
+    static int read(Stream &) { return *source ? (uint8_t)*source++ : -1; }
+    // the source as it takes a request, which is only ever to read
+    template <class Request>
+    static int read(Stream &s, Request) { return read(s); }
+};
+
+int main()
+{
+  char line[202];
+  for (int i = 0; i < 200; i++) line[i] = 'a' + i % 26;
+  line[200] = '\n';
+  line[201] = 0;
+
+  LineStream stream;
+  source = line;
+  String s = stream.readStringUntil('\n');
+  printf("length=%u malloc=%lu realloc=%lu free=%lu copied=%lu peak_heap=%u\n",
+         s.length(), heapMallocs, heapReallocs, heapFrees, heapCopied,
+         (unsigned)heapPeak);
+  return 0;
+}
@@ -0,0 +1,36 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Heap calls per telemetry packet built as one String sum of 13
+|| | parts: strings, integers and a float.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include <stdio.h>
+
+int main()
+{
+  String node("node7");
+  unsigned long mallocs = 0, reallocs = 0, frees = 0, copied = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    heapResetCounts();
+    String packet = String("T,") + node + "," + (unsigned long)i * 1000UL + "," +
+                    (i % 40 - 10) + "," + (i & 1023) + "," + 3.3 + ",OK";
+    mallocs += heapMallocs;
+    reallocs += heapReallocs;
+    frees += heapFrees;
+    copied += heapCopied;
+    if (i == 999) printf("%s\n", packet.c_str());
+  }
+  printf("per packet: malloc=%.2f realloc=%.2f free=%.2f copied=%.1f\n",
+         mallocs / 1000.0, reallocs / 1000.0, frees / 1000.0, copied / 1000.0);
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | The allocator behind heap.h.  Like avr-libc's it puts a 2-byte
+|| | size before each block, keeps an address ordered free list that
+|| | coalesces neighbours, takes the first free block that fits, and
+|| | grows a block in place at the heap top or into a free neighbour.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#define HEAP_SIZE 1024
+#define HEAP_MAX_FREE 256
+#define HEADER 2
+
+struct Block
+{
+  size_t offset, size;  // size includes the header
+};
+
+static uint8_t arena[HEAP_SIZE];
+static size_t top;
+static struct Block freeList[HEAP_MAX_FREE];
+static int freeCount;
+static size_t inUse;
+
+unsigned long heapMallocs, heapReallocs, heapFrees, heapFailures;
+unsigned long heapCopied;
+size_t heapPeak, heapPeakInUse;
+
+static size_t blockSize(size_t offset)
+{
+  return *(uint16_t *)(arena + offset);
+}
+
+static void *take(size_t offset, size_t size)
+{
+  *(uint16_t *)(arena + offset) = size;
+  inUse += size;
+  if (inUse > heapPeakInUse) heapPeakInUse = inUse;
+  return arena + offset + HEADER;
+}
+
+static void removeFree(int i)
+{
+  memmove(freeList + i, freeList + i + 1, (freeCount - i - 1) * sizeof(*freeList));
+  freeCount--;
+}
+
+static void addFree(size_t offset, size_t size)
+{
+  int i = 0;
+  while (i < freeCount && freeList[i].offset < offset) i++;
+  memmove(freeList + i + 1, freeList + i, (freeCount - i) * sizeof(*freeList));
+  freeList[i].offset = offset;
+  freeList[i].size = size;
+  freeCount++;
+  if (i + 1 < freeCount && offset + size == freeList[i + 1].offset)
+  {
+    freeList[i].size += freeList[i + 1].size;
+    removeFree(i + 1);
+  }
+  if (i > 0 && freeList[i - 1].offset + freeList[i - 1].size == offset)
+  {
+    freeList[i - 1].size += freeList[i].size;
+    removeFree(i);
+    i--;
+  }
+  // a free block at the top gives its space back to the heap
+  if (freeList[i].offset + freeList[i].size == top)
+  {
+    top = freeList[i].offset;
+    removeFree(i);
+  }
+}
+
+static void *allocate(size_t size)
+{
+  size_t need = (size < 2 ? 2 : size) + HEADER;
+  for (int i = 0; i < freeCount; i++)
+  {
+    if (freeList[i].size < need) continue;
+    size_t offset = freeList[i].offset;
+    // a remainder too small to hold a block stays with this one
+    if (freeList[i].size - need >= 2 + HEADER)
+    {
+      freeList[i].offset += need;
+      freeList[i].size -= need;
+    }
+    else
+    {
+      need = freeList[i].size;
+      removeFree(i);
+    }
+    return take(offset, need);
+  }
+  if (top + need > HEAP_SIZE)
+  {
+    heapFailures++;
+    return NULL;
+  }
+  size_t offset = top;
+  top += need;
+  if (top > heapPeak) heapPeak = top;
+  return take(offset, need);
+}
+
+void *heapMalloc(size_t size)
+{
+  heapMallocs++;
+  return allocate(size);
+}
+
+void heapFree(void *ptr)
+{
+  if (!ptr) return;
+  heapFrees++;
+  size_t offset = (uint8_t *)ptr - arena - HEADER;
+  inUse -= blockSize(offset);
+  addFree(offset, blockSize(offset));
+}
+
+void *heapRealloc(void *ptr, size_t size)
+{
+  heapReallocs++;
+  if (!ptr) return allocate(size);
+  size_t offset = (uint8_t *)ptr - arena - HEADER;
+  size_t current = blockSize(offset);
+  size_t need = (size < 2 ? 2 : size) + HEADER;
+  if (need <= current) return ptr;
+
+  // at the top of the heap, or followed by a big enough free block
+  if (offset + current == top && offset + need <= HEAP_SIZE)
+  {
+    inUse -= current;
+    top = offset + need;
+    if (top > heapPeak) heapPeak = top;
+    take(offset, need);
+    return ptr;
+  }
+  for (int i = 0; i < freeCount; i++)
+  {
+    if (freeList[i].offset != offset + current) continue;
+    size_t total = current + freeList[i].size;
+    if (total < need) break;
+    removeFree(i);
+    if (total - need >= 2 + HEADER)
+    {
+      addFree(offset + need, total - need);
+      total = need;
+    }
+    inUse -= current;
+    take(offset, total);
+    return ptr;
+  }
+
+  void *moved = allocate(size);
+  if (!moved) return NULL;
+  memcpy(moved, ptr, current - HEADER);
+  heapCopied += current - HEADER;
+  inUse -= current;
+  addFree(offset, current);
+  return moved;
+}
+
+size_t heapFragments(size_t *largest)
+{
+  size_t total = 0;
+  *largest = HEAP_SIZE - top;
+  for (int i = 0; i < freeCount; i++)
+  {
+    total += freeList[i].size;
+    if (freeList[i].size - HEADER > *largest) *largest = freeList[i].size - HEADER;
+  }
+  return total;
+}
+
+void heapResetCounts(void)
+{
+  heapMallocs = heapReallocs = heapFrees = heapFailures = 0;
+  heapCopied = 0;
+}
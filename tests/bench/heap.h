@@ -0,0 +1,53 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Counting heap for the host benchmarks: malloc, realloc and free
+|| | are redirected to an avr-libc style first-fit allocator over a
+|| | 1 KB arena that keeps the statistics below.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#ifndef BENCH_HEAP_H
+#define BENCH_HEAP_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#ifdef __cplusplus
+#include <cstdlib>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *heapMalloc(size_t size);
+void *heapRealloc(void *ptr, size_t size);
+void heapFree(void *ptr);
+
+// calls made, failures, and bytes realloc() had to copy
+extern unsigned long heapMallocs, heapReallocs, heapFrees, heapFailures;
+extern unsigned long heapCopied;
+// high water marks of the heap top and of the bytes in use
+extern size_t heapPeak, heapPeakInUse;
+
+// total bytes in free blocks below the heap top; *largest is the
+// biggest block that could still be allocated
+size_t heapFragments(size_t *largest);
+void heapResetCounts(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define malloc heapMalloc
+#define realloc heapRealloc
+#define free heapFree
+
+#endif
+// BENCH_HEAP_H
@@ -0,0 +1,18 @@
+/*
+|| Host stand-in for avr/interrupt.h: cli() and sei() change the I bit
+|| of the host SREG, and a handler is a plain function.
+*/
+
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define cli() (SREG &= ~_BV(SREG_I))
+#define sei() (SREG |= _BV(SREG_I))
+#define ISR_NAKED
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR(vector, ...) extern "C" void vector(void); void vector(void)
+
+#endif
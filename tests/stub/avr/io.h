@@ -0,0 +1,89 @@
+/*
+|| Host stand-in for avr/io.h: an ATmega328P whose registers are an
+|| array in host memory, so tests can run register-level code and
+|| inspect the result.
+*/
+
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+#define __AVR_ATmega328P__ 1
+#define RAMEND 0x8FF
+
+// data space 0x00-0xFF; weak so every test file shares one copy
+volatile uint8_t _avrIO[0x100] __attribute__((weak));
+
+#define __SFR_OFFSET 0x20
+#define _MMIO_BYTE(mem_addr) (_avrIO[mem_addr])
+#define _MMIO_WORD(mem_addr) (*(volatile uint16_t *)&_avrIO[mem_addr])
+#define _SFR_IO8(io_addr) _MMIO_BYTE((io_addr) + __SFR_OFFSET)
+#define _SFR_MEM8(mem_addr) _MMIO_BYTE(mem_addr)
+#define _SFR_MEM16(mem_addr) _MMIO_WORD(mem_addr)
+#define _SFR_MEM_ADDR(sfr) ((uint16_t)(&(sfr) - _avrIO))
+#define _SFR_IO_ADDR(sfr) (_SFR_MEM_ADDR(sfr) - __SFR_OFFSET)
+#define _BV(bit) (1 << (bit))
+
+#define SREG _SFR_IO8(0x3F)
+#define SREG_I 7
+
+#define PINB _SFR_IO8(0x03)
+#define DDRB _SFR_IO8(0x04)
+#define PORTB _SFR_IO8(0x05)
+#define PINC _SFR_IO8(0x06)
+#define DDRC _SFR_IO8(0x07)
+#define PORTC _SFR_IO8(0x08)
+#define PIND _SFR_IO8(0x09)
+#define DDRD _SFR_IO8(0x0A)
+#define PORTD _SFR_IO8(0x0B)
+
+#define TIFR0 _SFR_IO8(0x15)
+#define TOV0 0
+#define TCCR0A _SFR_IO8(0x24)
+#define TCCR0B _SFR_IO8(0x25)
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define TCNT0 _SFR_IO8(0x26)
+#define TIMSK0 _SFR_MEM8(0x6E)
+#define TOIE0 0
+
+#define SPCR _SFR_IO8(0x2C)
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define SPSR _SFR_IO8(0x2D)
+#define SPIF 7
+#define SPDR _SFR_IO8(0x2E)
+
+#define UCSR0A _SFR_MEM8(0xC0)
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define MPCM0 0
+#define UCSR0B _SFR_MEM8(0xC1)
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSR0C _SFR_MEM8(0xC2)
+#define UBRR0L _SFR_MEM8(0xC4)
+#define UBRR0H _SFR_MEM8(0xC5)
+#define UDR0 _SFR_MEM8(0xC6)
+
+#define TIMER0_OVF_vect __vector_16
+// -DSTUB_NO_USART makes this a part without a USART, such as an
+// ATtiny85, whose Serial is the bit-banged SoftSerial
+#ifndef STUB_NO_USART
+#define USART_RX_vect __vector_18
+#define USART_UDRE_vect __vector_19
+#define USART_TX_vect __vector_20
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+/*
+|| Included with -include by tests that count heap calls: malloc(),
+|| realloc() and free() count each call and go on to the C library's,
+|| so a test can check that an operation didn't touch the heap.
+*/
+
+#ifndef STUB_HEAP_H
+#define STUB_HEAP_H
+
+#include <stdlib.h>
+#ifdef __cplusplus
+#include <cstdlib>
+#endif
+
+// calls since the test last cleared them; weak so every file shares
+// one copy
+unsigned long heapMallocs __attribute__((weak));
+unsigned long heapReallocs __attribute__((weak));
+unsigned long heapFrees __attribute__((weak));
+
+static inline void *heapMalloc(size_t size)
+{
+  heapMallocs++;
+  return malloc(size);
+}
+
+static inline void *heapRealloc(void *ptr, size_t size)
+{
+  heapReallocs++;
+  return realloc(ptr, size);
+}
+
+static inline void heapFree(void *ptr)
+{
+  if (ptr) heapFrees++;
+  free(ptr);
+}
+
+#define malloc heapMalloc
+#define realloc heapRealloc
+#define free heapFree
+
+#endif
@@ -0,0 +1,61 @@
+/*
+|| Included ahead of every file of a host test build: what avr-gcc and
+|| avr-libc provide beyond the standard library.
+*/
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+// cycles the delay functions would have spent, and a function they
+// call after each delay so that a test can change inputs as time passes
+uint32_t delayCycles __attribute__((weak));
+void (*delayHook)(void) __attribute__((weak));
+
+#define __builtin_avr_delay_cycles(cycles) (delayCycles += (cycles))
+
+// avr-libc number to text conversions, at the host's int size
+static inline char *ultoa(unsigned long value, char *buf, int radix)
+{
+  char tmp[33];
+  char *p = tmp;
+  do {
+    int digit = value % radix;
+    *p++ = digit < 10 ? digit + '0' : digit + 'a' - 10;
+    value /= radix;
+  } while (value);
+  char *s = buf;
+  while (p > tmp) *s++ = *--p;
+  *s = 0;
+  return buf;
+}
+
+static inline char *ltoa(long value, char *buf, int radix)
+{
+  if (value < 0 && radix == 10)
+  {
+    *buf = '-';
+    ultoa(0 - (unsigned long)value, buf + 1, radix);
+    return buf;
+  }
+  return ultoa(value, buf, radix);
+}
+
+static inline char *utoa(unsigned value, char *buf, int radix)
+{
+  return ultoa(value, buf, radix);
+}
+
+static inline char *itoa(int value, char *buf, int radix)
+{
+  if (radix != 10) return utoa(value, buf, radix);
+  return ltoa(value, buf, radix);
+}
+
+#endif
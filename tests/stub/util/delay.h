@@ -0,0 +1,13 @@
+/*
+|| Host stand-in for util/delay.h.
+*/
+
+#ifndef _UTIL_DELAY_H_
+#define _UTIL_DELAY_H_
+
+#include <util/delay_basic.h>
+
+static inline void _delay_ms(double ms) { delayCycles += ms * (F_CPU / 1000); }
+static inline void _delay_us(double us) { delayCycles += us * (F_CPU / 1000000.0); }
+
+#endif
@@ -0,0 +1,27 @@
+/*
+|| Host stand-in for util/delay_basic.h: the loops don't wait, they add
+|| up the cycles they would have taken in delayCycles and then call
+|| delayHook if it is set (host.h).
+*/
+
+#ifndef _UTIL_DELAY_BASIC_H_
+#define _UTIL_DELAY_BASIC_H_
+
+#include <stdint.h>
+
+extern uint32_t delayCycles;
+extern void (*delayHook)(void);
+
+static inline void _delay_loop_1(uint8_t count)
+{
+  delayCycles += 3 * (count ? count : 256);
+  if (delayHook) delayHook();
+}
+
+static inline void _delay_loop_2(uint16_t count)
+{
+  delayCycles += 4 * (count ? count : 65536UL);
+  if (delayHook) delayHook();
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+|| Minimal checks for the host tests.  A failed check prints where and
+|| what, and the test's main() returns the number of failures.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+static int testFailures;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) \
+    { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(got, want) \
+  do { \
+    long long got_ = (got), want_ = (want); \
+    if (got_ != want_) \
+    { \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+             #got, got_, want_); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_TEXT(got, want) \
+  do { \
+    const char *got_ = (got), *want_ = (want); \
+    if (strcmp(got_, want_)) \
+    { \
+      printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, \
+             #got, got_, want_); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define TEST_RESULT() (printf("%s: %d failed\n", __FILE__, testFailures), \
+                       testFailures != 0)
+
+#endif
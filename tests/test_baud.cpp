@@ -0,0 +1,78 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the USART baud rate settings (_UsartBaud), compile
+|| | time and runtime, at the F_CPU of the build.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <math.h>
+#include "Wiring.h"
+#include "test.h"
+
+typedef _UsartBaud Baud;
+
+// percent error of the bit time a setting gives
+static double rateError(uint32_t baud, uint16_t setting)
+{
+  uint8_t div = (setting & Baud::U2X_SETTING) ? 8 : 16;
+  double cycles = (double)div * ((setting & 0x0FFF) + 1) * baud;
+  return fabs(cycles - F_CPU) * 100 / F_CPU;
+}
+
+static const uint32_t rates[] =
+  { 300, 1200, 2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600,
+    76800, 115200, 230400, 250000, 500000, 1000000 };
+
+#if F_CPU == 16000000UL
+static_assert(Baud::setting(9600) == 103, "9600 baud, UBRR 103");
+static_assert(Baud::setting(115200) == (Baud::U2X_SETTING | 16),
+              "115200 baud, U2X UBRR 16");
+static_assert(Baud::error(115200) <= SERIAL_BAUD_ERROR_MAX,
+              "115200 baud at 16 MHz");
+static_assert(Baud::error(230400) > SERIAL_BAUD_ERROR_MAX,
+              "230400 baud at 16 MHz");
+#endif
+
+int main()
+{
+  for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+  {
+    uint32_t baud = rates[i];
+    if (F_CPU / 16 / baud > 4096) continue;   // too slow for UBRR
+
+    // error() is the error of setting(), in tenths of a percent
+    uint16_t setting = Baud::setting(baud);
+    CHECK_EQUAL(setting & 0x7000, 0);
+    CHECK(fabs(rateError(baud, setting) * 10 - Baud::error(baud)) <= 0.5);
+
+    // the runtime calculation is at most 0.5% further off
+    uint16_t runtime = Baud::runtimeSetting(baud);
+    CHECK_EQUAL(runtime & 0x7000, 0);
+    if (rateError(baud, runtime) > rateError(baud, setting) + 0.5)
+    {
+      printf("%lu baud: runtime setting %04x is %.2f%% off, %04x %.2f%%\n",
+             (unsigned long)baud, runtime, rateError(baud, runtime),
+             setting, rateError(baud, setting));
+      CHECK(false);
+    }
+  }
+
+#if F_CPU == 16000000UL
+  CHECK_EQUAL(Baud::runtimeSetting(9600), 103);
+  CHECK_EQUAL(Baud::runtimeSetting(115200), Baud::U2X_SETTING | 16);
+#endif
+
+  // faster than the USART can go: the fastest setting, not UBRR 0xFFF
+  CHECK_EQUAL(Baud::runtimeSetting(F_CPU / 8), Baud::U2X_SETTING);
+  CHECK_EQUAL(Baud::runtimeSetting(F_CPU / 2), Baud::U2X_SETTING);
+  CHECK_EQUAL(Baud::runtimeSetting(F_CPU), Baud::U2X_SETTING);
+
+  return TEST_RESULT();
+}
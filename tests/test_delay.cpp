@@ -0,0 +1,65 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the delay arithmetic in main.cpp: the cycles a
+|| | runtime delayMicroseconds() spends, counted by the stub delay
+|| | loops, against the cycles asked for, at the F_CPU of the build.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+// main.cpp with its main() renamed, so this file has the test's
+#define main wiringMain
+#include "../main.cpp"
+#undef main
+
+void setup() {}
+void loop() {}
+
+int main()
+{
+  for (uint32_t us = 0; us <= 0xFFFF; us++)
+  {
+    uint32_t want = (uint64_t)us * F_CPU / 1000000;
+    delayCycles = 0;
+    _delayMicroseconds(us);
+    uint32_t got = delayCycles;
+    if (got) got += DELAYUS_OVERHEAD;
+
+    // one loop pass, plus the rounding of LOOPS_PER_US_Q8
+    uint32_t slack = 4 + want / 1000;
+    if (want < DELAYUS_OVERHEAD + 4)
+    {
+      // too short to do more than return
+      CHECK(got == 0 || got <= want + slack);
+      continue;
+    }
+    if (got + slack < want || got > want + slack)
+    {
+      printf("delayMicroseconds(%u): %u cycles, expected %u\n",
+             (unsigned)us, (unsigned)got, (unsigned)want);
+      CHECK(false);
+      break;
+    }
+  }
+
+  // a constant argument is exact
+  delayCycles = 0;
+  delayMicroseconds(250);
+  CHECK_EQUAL(delayCycles, F_CPU / 4000);
+
+  // the busy-wait delay() leaves 4 cycles a millisecond for its loop
+  delayCycles = 0;
+  delay(3);
+  CHECK_EQUAL(delayCycles, 3 * (F_CPU / 1000 - 4));
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,145 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the compile-time format parser in WFormat.h: each
+|| | format printed with printf(Format(...)) against the C library's
+|| | printf, or the expected text where the two differ.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+static PrintBuffer<80> out;
+
+static void checkFormat(size_t n, const char *want)
+{
+  CHECK_TEXT(out.c_str(), want);
+  CHECK_EQUAL(n, out.length());
+  out.clear();
+}
+
+// the format as printf() would print it
+#define CHECK_PRINTF(format, ...) \
+  do \
+  { \
+    char want[80]; \
+    snprintf(want, sizeof(want), format, __VA_ARGS__); \
+    checkFormat(out.printf(Format(format), __VA_ARGS__), want); \
+  } while (0)
+
+#define CHECK_FORMAT(want, format, ...) \
+  checkFormat(out.printf(Format(format), ##__VA_ARGS__), want)
+
+enum Colour { RED, GREEN = 7 };
+enum class Level : uint8_t { LOW_LEVEL, HIGH_LEVEL = 200 };
+
+int main()
+{
+  CHECK_FORMAT("", "");
+  CHECK_FORMAT("plain text", "plain text");
+  CHECK_FORMAT("x", "x");
+  CHECK_FORMAT("100%", "100%%");
+  CHECK_FORMAT("%d", "%%d");
+
+  static const int ints[] = { 0, 1, -1, 9, 10, -10, 999, 32767, -32768 };
+  for (uint8_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++)
+  {
+    int n = ints[i];
+    CHECK_PRINTF("%d", n);
+    CHECK_PRINTF("%i|", n);
+    CHECK_PRINTF("[%5d]", n);
+    CHECK_PRINTF("[%-5d]", n);
+    CHECK_PRINTF("[%05d]", n);
+    CHECK_PRINTF("[%1d]", n);
+    CHECK_PRINTF("n=%d, m=%d.", n, n / 3);
+  }
+
+  static const long longs[] = { 0, 65536, -65537, 2147483647, -2147483647 - 1 };
+  for (uint8_t i = 0; i < sizeof(longs) / sizeof(longs[0]); i++)
+  {
+    long n = longs[i];
+    CHECK_PRINTF("%ld", n);
+    CHECK_PRINTF("[%12ld]", n);
+    CHECK_PRINTF("[%-12ld]", n);
+    CHECK_PRINTF("[%012ld]", n);
+  }
+
+  static const unsigned long unsigneds[] = { 0, 7, 255, 4096, 65535, 4294967295UL };
+  for (uint8_t i = 0; i < sizeof(unsigneds) / sizeof(unsigneds[0]); i++)
+  {
+    unsigned long n = unsigneds[i];
+    CHECK_PRINTF("%lu", n);
+    CHECK_PRINTF("[%10lu]", n);
+    CHECK_PRINTF("%lo", n);
+    CHECK_PRINTF("[%012lo]", n);
+    CHECK_PRINTF("%lX", n);
+    CHECK_PRINTF("[%08lX]", n);
+    CHECK_PRINTF("[%-8lX]", n);
+  }
+
+  // hex is always upper case, and binary is an extension
+  CHECK_FORMAT("BEEF", "%x", 0xbeef);
+  CHECK_FORMAT("reg 0A = 00000101", "reg %02X = %08b", 10, 5);
+  CHECK_FORMAT("101", "%b", 5);
+  CHECK_FORMAT("[  101]", "[%5b]", 5);
+  CHECK_FORMAT("[101  ]", "[%-5b]", 5);
+
+  // negative numbers print as unsigned of their own size, at least 16 bits
+  CHECK_FORMAT("FFFF", "%x", (int16_t)-1);
+  CHECK_FORMAT("FFFF", "%x", (int8_t)-1);
+  CHECK_FORMAT("FFFFFFFE", "%lx", (int32_t)-2);
+  CHECK_FORMAT("65535", "%u", (int16_t)-1);
+  CHECK_FORMAT("177777", "%o", (int16_t)-1);
+
+  // a char prints as a character with %c and its code otherwise
+  CHECK_PRINTF("%c", 'A');
+  CHECK_PRINTF("[%3c]", 'A');
+  CHECK_PRINTF("[%-3c]", 'A');
+  CHECK_FORMAT("65 41", "%d %x", 'A', 'A');
+  CHECK_FORMAT("B", "%c", 66);
+
+  // enums print their value
+  CHECK_FORMAT("0 7", "%d %d", RED, GREEN);
+  CHECK_FORMAT("200 C8", "%u %X", Level::HIGH_LEVEL, Level::HIGH_LEVEL);
+
+  // %s takes anything print() does, padded by what it prints
+  CHECK_PRINTF("%s", "text");
+  CHECK_PRINTF("[%8s]", "text");
+  CHECK_PRINTF("[%-8s]", "text");
+  CHECK_PRINTF("[%2s]", "text");
+  CHECK_FORMAT("[  String]", "[%8s]", String("String"));
+  CHECK_FORMAT("[flash ]", "[%-6s]", Constant("flash"));
+  CHECK_FORMAT("[   42]", "[%5s]", 42);
+
+  static const double reals[] = { 0, 1, -1, 0.375, 3.14159, -2.71828, 1234.5678 };
+  for (uint8_t i = 0; i < sizeof(reals) / sizeof(reals[0]); i++)
+  {
+    double x = reals[i];
+    CHECK_PRINTF("%f", x);
+    CHECK_PRINTF("%.0f", x);
+    CHECK_PRINTF("%.2f", x);
+    CHECK_PRINTF("[%10.3f]", x);
+    CHECK_PRINTF("[%-10.3f]", x);
+    CHECK_PRINTF("[%010.3f]", x);
+    CHECK_PRINTF("%F", (float)x);
+  }
+  CHECK_FORMAT("1.500 V", "%.3f V", Fixed16_16::fromFloat(1.5));
+  CHECK_FORMAT("[ -0.25]", "[%6.2f]", Fixed8_8::fromFloat(-0.25));
+  CHECK_FORMAT("[-00.25]", "[%06.2f]", Fixed8_8::fromFloat(-0.25));
+
+  // the example in WFormat.h
+  CHECK_FORMAT("inside:  21.05 C\r\n", "%s: %3d.%02u C\r\n", "inside", 21, 5u);
+
+  // a format of exactly FORMAT_MAX_LENGTH characters
+  CHECK_FORMAT("0123456789012345678901234567890123456789012345678901234567890123",
+               "0123456789012345678901234567890123456789012345678901234567890123");
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,170 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the number converters in Print.cpp: _decimal,
+|| | _fixedFormat, _fixedFormatWide and _floatFormat, and print() in
+|| | each base, against the C library or exact integer arithmetic.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <math.h>
+#include "Wiring.h"
+#include "test.h"
+
+static uint32_t seed = 12345;
+static uint32_t random32()
+{
+  seed = seed * 1664525 + 1013904223;
+  return seed;
+}
+
+static void checkDecimal(uint32_t n)
+{
+  char got[12], want[12];
+  *_decimal(got, n) = 0;
+  snprintf(want, sizeof(want), "%lu", (unsigned long)n);
+  CHECK_TEXT(got, want);
+}
+
+// magnitude / 2^fracBits to digits places, rounded half up
+static void fixedReference(char *buf, uint32_t magnitude, bool negative,
+                           uint8_t fracBits, uint8_t digits)
+{
+  uint64_t scale = 1;
+  for (uint8_t i = 0; i < digits; i++) scale *= 10;
+  uint64_t q = ((uint64_t)magnitude * scale * 2 + (1ULL << fracBits))
+               >> (fracBits + 1);
+  if (!q) negative = false;
+  buf += sprintf(buf, "%s%llu", negative ? "-" : "",
+                 (unsigned long long)(q / scale));
+  if (digits)
+    sprintf(buf, ".%0*llu", digits, (unsigned long long)(q % scale));
+}
+
+static void checkFixed(uint32_t magnitude, bool negative, uint8_t fracBits,
+                       uint8_t digits)
+{
+  char got[FORMAT_BUFFER_SIZE], want[32];
+  fixedReference(want, magnitude, negative, fracBits, digits);
+  uint8_t len = _fixedFormatWide(got, magnitude, negative, fracBits, digits);
+  CHECK_TEXT(got, want);
+  CHECK_EQUAL(len, strlen(got));
+  if (fracBits > FIXED_FORMAT_BITS) return;
+  len = _fixedFormat(got, magnitude, negative, fracBits, digits);
+  CHECK_TEXT(got, want);
+  CHECK_EQUAL(len, strlen(got));
+}
+
+// the digits of number unless it is within rounding noise of a half
+static void checkFloat(double number, uint8_t digits)
+{
+  double scaled = fabs(number) * pow(10, digits);
+  if (fabs(scaled - floor(scaled) - 0.5) < 1e-6) return;
+  char got[FORMAT_BUFFER_SIZE], want[32];
+  uint8_t len = _floatFormat(got, number, digits);
+  snprintf(want, sizeof(want), "%.*f", digits, number);
+  // the C library keeps the sign of a negative number rounded to 0
+  if (!strncmp(want, "-0", 2) && !strpbrk(want, "123456789"))
+    memmove(want, want + 1, strlen(want));
+  CHECK_TEXT(got, want);
+  CHECK_EQUAL(len, strlen(got));
+}
+
+static const char *printed(unsigned long n, int base)
+{
+  static PrintBuffer<40> buf;
+  buf.clear();
+  buf.print(n, base);
+  return buf.c_str();
+}
+
+int main()
+{
+  for (uint32_t n = 0; n < 200000; n++) checkDecimal(n);
+  for (uint32_t p = 10; p < 1000000000; p *= 10)
+  {
+    checkDecimal(p - 1);
+    checkDecimal(p);
+    checkDecimal(p * 9);
+  }
+  checkDecimal(0xFFFFFFFF);
+  for (int i = 0; i < 100000; i++) checkDecimal(random32());
+
+  char want[40];
+  for (int i = 0; i < 20000; i++)
+  {
+    uint32_t n = random32() >> (i % 32);
+    snprintf(want, sizeof(want), "%lX", (unsigned long)n);
+    CHECK_TEXT(printed(n, HEX), want);
+    snprintf(want, sizeof(want), "%lo", (unsigned long)n);
+    CHECK_TEXT(printed(n, OCT), want);
+    snprintf(want, sizeof(want), "%lu", (unsigned long)n);
+    CHECK_TEXT(printed(n, DEC), want);
+  }
+  CHECK_TEXT(printed(0, BIN), "0");
+  CHECK_TEXT(printed(0xA5, BIN), "10100101");
+  CHECK_TEXT(printed(0x80000000, BIN), "10000000000000000000000000000000");
+  CHECK_TEXT(printed(35 * 36 + 1, 36), "Z1");
+  CHECK_TEXT(printed(12, 1), "12");
+
+  // every fraction width and places, exact to 9 places
+  static const uint8_t fracBits[] = { 0, 1, 4, 8, 12, 16, 24, 28, 30, 31 };
+  for (uint8_t f = 0; f < sizeof(fracBits); f++)
+  {
+    for (uint8_t digits = 0; digits <= 9; digits++)
+    {
+      for (int i = 0; i < 2000; i++)
+      {
+        uint32_t magnitude = random32() >> (i % 32);
+        checkFixed(magnitude, i & 1, fracBits[f], digits);
+      }
+      checkFixed(0, true, fracBits[f], digits);
+      checkFixed(0xFFFFFFFF, false, fracBits[f], digits);
+      checkFixed(1, false, fracBits[f], digits);
+      // a half, and the largest fraction
+      checkFixed((1ULL << fracBits[f]) >> 1, false, fracBits[f], digits);
+      checkFixed((1ULL << fracBits[f]) - 1, true, fracBits[f], digits);
+    }
+  }
+
+  // Fixed16_16 to 5 and 9 places
+  char buf[FORMAT_BUFFER_SIZE];
+  Fixed16_16::fromFloat(3.14159).format(buf, 5);
+  CHECK_TEXT(buf, "3.14159");
+  (Fixed16_16(1) / Fixed16_16(3)).format(buf, 9);
+  CHECK_TEXT(buf, "0.333328247");
+  (-Fixed16_16(1) / Fixed16_16(3)).format(buf, 4);
+  CHECK_TEXT(buf, "-0.3333");
+  Fixed8_8::fromFloat(-128).format(buf, 2);
+  CHECK_TEXT(buf, "-128.00");
+  // more than 9 places gives 9
+  Fixed16_16::fromRaw(1).format(buf, 12);
+  CHECK_TEXT(buf, "0.000015259");
+
+  for (int i = 0; i < 20000; i++)
+  {
+    double number = (int32_t)random32() / 1000.0 / (1 << (i % 20));
+    checkFloat(number, i % 10);
+  }
+  checkFloat(0, 2);
+  checkFloat(1.999, 2);
+  checkFloat(-0.001, 2);
+  checkFloat(4294967040.0, 0);
+
+  _floatFormat(buf, NAN, 2);
+  CHECK_TEXT(buf, "nan");
+  _floatFormat(buf, -INFINITY, 2);
+  CHECK_TEXT(buf, "inf");
+  _floatFormat(buf, 5e9, 2);
+  CHECK_TEXT(buf, "ovf");
+  _floatFormat(buf, 1.0 / 3, 12);
+  CHECK_TEXT(buf, "0.333333333");
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,91 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of PackedString: strings packed by tools/packstrings.py
+|| | from packed_strings.txt decode, print and join Strings as the
+|| | plain text they were packed from.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "packed.h"
+#include "test.h"
+
+struct Case
+{
+  PackedString packed;
+  const char *text;
+};
+
+static const Case cases[] = {
+  { help_set, "set <name> <value>    change a setting\r\n" },
+  { help_get, "get <name>            show a setting\r\n" },
+  { help_list, "list                  show every setting\r\n" },
+  { help_save, "save                  store every setting in EEPROM\r\n" },
+  { err_range, "error: value out of range\r\n" },
+  { err_name, "error: no setting of that name\r\n" },
+  { err_busy, "error: busy, try again\r\n" },
+  { setting, " setting" },
+  { empty, "" },
+  { single, "x" },
+  { escapes, "tab\there \"quoted\" back\\slash \x7f" },
+};
+
+static void checkCase(const PackedString &packed, const char *text)
+{
+  size_t len = strlen(text);
+  CHECK_EQUAL(packed.length(), len);
+
+  // decode stops at the end given, and writes nothing past it
+  char buf[80];
+  for (size_t room = 0; room <= len + 1; room++)
+  {
+    memset(buf, '#', sizeof(buf));
+    char *end = packed.decode(buf, buf + room);
+    size_t got = room < len ? room : len;
+    CHECK_EQUAL(end - buf, got);
+    CHECK(!memcmp(buf, text, got));
+    CHECK_EQUAL(buf[got], '#');
+  }
+
+  PrintBuffer<80> out;
+  CHECK_EQUAL(out.print(packed), len);
+  CHECK_TEXT(out.c_str(), text);
+
+  String s(packed);
+  CHECK_TEXT(s.c_str(), text);
+  s = "> ";
+  s += packed;
+  CHECK_EQUAL(s.length(), len + 2);
+  CHECK_TEXT(s.c_str() + 2, text);
+  s = packed;
+  CHECK_TEXT(s.c_str(), text);
+
+  String sum(String("[") + packed + ']');
+  CHECK_EQUAL(sum.length(), len + 2);
+  CHECK(!strncmp(sum.c_str() + 1, text, len));
+  CHECK_TEXT(sum.c_str() + len + 1, "]");
+}
+
+int main()
+{
+  for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    checkCase(cases[i].packed, cases[i].text);
+
+  // the shared text went into the dictionary
+  CHECK(strlen((const char *)packed_help_save) < strlen(cases[3].text));
+  CHECK(strlen((const char *)packed_setting) == 1);
+
+  // a String that can't hold it all is truncated, not overrun
+  StaticString<16> fixed(help_set);
+  CHECK_TEXT(fixed.c_str(), "set <name> <valu");
+  CHECK(fixed.truncated());
+
+  return TEST_RESULT();
+}
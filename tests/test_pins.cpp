@@ -0,0 +1,237 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the runtime pin functions (WDigital.cpp): each pin
+|| | number reaches its own bit of the right register through the flash
+|| | tables, on the ATmega328P of stub/avr/io.h.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+// the Uno numbering: D0-D7 on PORTD, D8-D13 on PORTB, A0-A5 on PORTC
+static volatile uint8_t *expectedPin(uint8_t pin)
+{
+  if (pin < 8) return &PIND;
+  if (pin < 14) return &PINB;
+  return &PINC;
+}
+
+static uint8_t expectedMask(uint8_t pin)
+{
+  if (pin < 8) return 1 << pin;
+  if (pin < 14) return 1 << (pin - 8);
+  return 1 << (pin - 14);
+}
+
+// the only register bits set are those given
+static bool onlySet(volatile uint8_t *reg1, uint8_t mask1,
+                    volatile uint8_t *reg2 = 0, uint8_t mask2 = 0)
+{
+  for (unsigned i = 0; i < sizeof(_avrIO); i++)
+  {
+    uint8_t want = 0;
+    if (&_avrIO[i] == reg1) want |= mask1;
+    if (&_avrIO[i] == reg2) want |= mask2;
+    if (&_avrIO[i] == &SREG) continue;
+    if (_avrIO[i] != want) return false;
+  }
+  return true;
+}
+
+static void clearIO()
+{
+  memset((void *)_avrIO, 0, sizeof(_avrIO));
+}
+
+static uint32_t seed = 1;
+static uint8_t random8()
+{
+  seed = seed * 1664525 + 1013904223;
+  return seed >> 24;
+}
+
+static volatile uint8_t *const pinRegs[] = { &PINB, &PINC, &PIND };
+
+// index of a pin's port in pinRegs
+static uint8_t portIndex(uint8_t pin)
+{
+  volatile uint8_t *reg = expectedPin(pin);
+  return reg == &PINB ? 0 : reg == &PINC ? 1 : 2;
+}
+
+// Checks PinGroup<Pins...> against the pin table a bit at a time, with
+// random levels on the other pins of its ports.
+template <uint8_t... Pins>
+static void checkGroup()
+{
+  typedef PinGroup<Pins...> Group;
+  static const uint8_t pins[] = { Pins... };
+  const uint8_t count = sizeof(pins);
+
+  // the group's bits of each port
+  uint8_t groupMask[3] = { 0, 0, 0 };
+  for (uint8_t i = 0; i < count; i++)
+    groupMask[portIndex(pins[i])] |= expectedMask(pins[i]);
+
+  for (unsigned value = 0; value < (1u << count); value++)
+  {
+    uint8_t port[3], want[3];
+    clearIO();
+    for (uint8_t p = 0; p < 3; p++)
+    {
+      port[p] = random8();
+      pinRegs[p][WIRING_PORT_REG] = port[p];
+      want[p] = port[p] & ~groupMask[p];
+    }
+    for (uint8_t i = 0; i < count; i++)
+      if (value & (1 << i))
+        want[portIndex(pins[i])] |= expectedMask(pins[i]);
+
+    // write() flips just the group's bits that differ by writing them
+    // to PINx; the hardware toggles PORTx
+    Group::write(value);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+      uint8_t toggle = *pinRegs[p];
+      CHECK_EQUAL(toggle & ~groupMask[p], 0);
+      CHECK_EQUAL(pinRegs[p][WIRING_PORT_REG], port[p]);
+      CHECK_EQUAL(port[p] ^ toggle, want[p]);
+    }
+
+    // read() gathers the same bits from PINx
+    for (uint8_t p = 0; p < 3; p++)
+      *pinRegs[p] = want[p];
+    CHECK_EQUAL(Group::read(), value);
+    CHECK_EQUAL((uint8_t)Group(), value);
+  }
+
+  // mode() changes only the group's DDRx and PORTx bits
+  static const uint8_t modes[] = { OUTPUT, INPUT, INPUT_PULLUP, OUTPUT_OPEN_DRAIN };
+  for (uint8_t m = 0; m < sizeof(modes); m++)
+  {
+    uint8_t ddr[3], port[3];
+    clearIO();
+    for (uint8_t p = 0; p < 3; p++)
+    {
+      ddr[p] = pinRegs[p][WIRING_DDR_REG] = random8();
+      port[p] = pinRegs[p][WIRING_PORT_REG] = random8();
+    }
+    Group::mode(modes[m]);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+      uint8_t mask = groupMask[p];
+      uint8_t wantDdr = modes[m] == OUTPUT ? ddr[p] | mask : ddr[p] & ~mask;
+      uint8_t wantPort = modes[m] == INPUT_PULLUP ? port[p] | mask :
+                         modes[m] == OUTPUT ? port[p] : port[p] & ~mask;
+      CHECK_EQUAL(pinRegs[p][WIRING_DDR_REG], wantDdr);
+      CHECK_EQUAL(pinRegs[p][WIRING_PORT_REG], wantPort);
+    }
+  }
+}
+
+int main()
+{
+  for (uint8_t pin = 0; pin < TOTAL_PINS; pin++)
+  {
+    volatile uint8_t *pinReg = expectedPin(pin);
+    volatile uint8_t *ddr = pinReg + WIRING_DDR_REG;
+    volatile uint8_t *port = pinReg + WIRING_PORT_REG;
+    uint8_t mask = expectedMask(pin);
+
+    CHECK_EQUAL(portRegisterAddr(digitalPinToPort(pin), WIRING_PIN_REG),
+                _SFR_MEM_ADDR(*pinReg));
+    CHECK_EQUAL(digitalPinToBitMask(pin), mask);
+
+    clearIO();
+    _pinMode(pin, OUTPUT);
+    CHECK(onlySet(ddr, mask));
+    _pinWrite(pin, HIGH);
+    CHECK(onlySet(ddr, mask, port, mask));
+    _pinWrite(pin, LOW);
+    CHECK(onlySet(ddr, mask));
+
+    // pull-up on before the pin is released, so it never floats low
+    _pinMode(pin, INPUT_PULLUP);
+    CHECK(onlySet(port, mask));
+    _pinMode(pin, OUTPUT_OPEN_DRAIN);
+    CHECK(onlySet(0, 0));
+
+    // INPUT turns the pull-up off, as in Arduino
+    _pinMode(pin, INPUT_PULLUP);
+    _pinMode(pin, INPUT);
+    CHECK(onlySet(0, 0));
+    _pinMode(pin, OUTPUT);
+    _pinWrite(pin, HIGH);
+    _pinMode(pin, INPUT);
+    CHECK(onlySet(0, 0));
+
+    // other bits of the port are kept
+    *port = ~mask;
+    _pinWrite(pin, HIGH);
+    CHECK_EQUAL(*port, 0xFF);
+    _pinWrite(pin, LOW);
+    CHECK_EQUAL(*port, (uint8_t)~mask);
+
+    clearIO();
+    *pinReg = mask;
+    CHECK_EQUAL(_pinRead(pin), HIGH);
+    *pinReg = ~mask;
+    CHECK_EQUAL(_pinRead(pin), LOW);
+  }
+
+  // a constant pin number takes the inline path to the same bits
+  clearIO();
+  pinMode(WLED, OUTPUT);
+  digitalWrite(WLED, HIGH);
+  CHECK(onlySet(&DDRB, _BV(5), &PORTB, _BV(5)));
+  clearIO();
+  pinMode(16, INPUT_PULLUP);
+  CHECK(onlySet(&PORTC, _BV(2)));
+  PINC = _BV(2);
+  CHECK_EQUAL(digitalRead(16), HIGH);
+  pinMode(16, INPUT);
+  CHECK(onlySet(&PINC, _BV(2)));
+
+  // interrupts are disabled around the read-modify-write, then restored
+  clearIO();
+  SREG = _BV(SREG_I);
+  _pinWrite(WLED, HIGH);
+  CHECK_EQUAL(SREG, _BV(SREG_I));
+  SREG = 0;
+  _pinMode(WLED, INPUT_PULLUP);
+  CHECK_EQUAL(SREG, 0);
+
+  // out of range pins and ports are ignored
+  clearIO();
+  _pinMode(TOTAL_PINS, OUTPUT);
+  _pinWrite(TOTAL_PINS, HIGH);
+  _portMode(WIRING_PORTS, OUTPUT);
+  _portWrite(WIRING_PORTS, 0xFF);
+  CHECK(onlySet(0, 0));
+  CHECK_EQUAL(_pinRead(TOTAL_PINS), LOW);
+  CHECK_EQUAL(_portRead(WIRING_PORTS), 0);
+
+  // ports are in WIRING_PORT_REGS order
+  _portMode(1, OUTPUT);
+  _portWrite(1, 0xA5);
+  CHECK(onlySet(&DDRB, 0xFF, &PORTB, 0xA5));
+  PINC = 0x3C;
+  CHECK_EQUAL(_portRead(2), 0x3C);
+
+  // groups in port order, reversed, and across all three ports
+  checkGroup<4, 5, 6, 7>();
+  checkGroup<3, 2>();
+  checkGroup<13, 2, 8, 15, 0>();
+  checkGroup<9>();
+  checkGroup<0, 1, 2, 3, 4, 5, 6, 7>();
+
+  return TEST_RESULT();
+}
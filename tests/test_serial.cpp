@@ -0,0 +1,144 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the interrupt-driven HardwareSerial buffers: the test
+|| | plays the USART, setting its status bits and calling the RX and
+|| | UDRE interrupt handlers, and checks what reaches UDR0 and read().
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+#if SERIAL_TX_BUFFER_SIZE != 8 || SERIAL_RX_BUFFER_SIZE != 8
+#error "built with 8 byte buffers"
+#endif
+
+extern "C" void USART_RX_vect(void);
+extern "C" void USART_UDRE_vect(void);
+
+// the data register is empty again, as after a byte has been shifted out
+static void udrEmpty()
+{
+  UCSR0A |= _BV(UDRE0);
+}
+
+// a byte arrives; the handler reads it and so clears RXC
+static void receive(uint8_t c, uint8_t status = 0)
+{
+  UDR0 = c;
+  UCSR0A = _BV(RXC0) | status;
+  USART_RX_vect();
+  UCSR0A &= ~_BV(RXC0);
+}
+
+// the next byte the UDRE handler sends, or -1 when it is disabled
+static int transmit()
+{
+  if (!(UCSR0B & _BV(UDRIE0))) return -1;
+  UDR0 = 0;
+  USART_UDRE_vect();
+  return UDR0;
+}
+
+int main()
+{
+  memset((void *)_avrIO, 0, sizeof(_avrIO));
+  Serial.begin(9600);
+  CHECK_EQUAL(UBRR0H, 0);
+  CHECK_EQUAL(UBRR0L, 103);
+  CHECK_EQUAL(UCSR0A, 0);
+  CHECK_EQUAL(UCSR0B, _BV(RXCIE0) | _BV(RXEN0) | _BV(TXEN0));
+  CHECK(SREG & _BV(SREG_I));
+
+  // an idle port sends the first byte straight away
+  udrEmpty();
+  CHECK_EQUAL(Serial.availableForWrite(), 8);
+  CHECK_EQUAL(Serial.write('a'), 1);
+  CHECK_EQUAL(UDR0, 'a');
+  CHECK_EQUAL(UCSR0B & _BV(UDRIE0), 0);
+
+  // while it is busy the rest queue for the UDRE interrupt, in order;
+  // the free-running indices are exercised past their 8-bit wrap
+  for (int round = 0; round < 100; round++)
+  {
+    for (uint8_t i = 0; i < 8; i++) CHECK_EQUAL(Serial.write('0' + i), 1);
+    CHECK_EQUAL(Serial.availableForWrite(), 0);
+    CHECK(UCSR0B & _BV(UDRIE0));
+    for (uint8_t i = 0; i < 8; i++) CHECK_EQUAL(transmit(), '0' + i);
+    CHECK_EQUAL(transmit(), -1);
+    CHECK_EQUAL(Serial.availableForWrite(), 8);
+  }
+
+  // with interrupts off, a writer waiting for room sends bytes itself
+  // whenever the data register is empty
+  SREG &= ~_BV(SREG_I);
+  for (uint8_t i = 0; i < 8; i++) Serial.write('A' + i);
+  udrEmpty();
+  CHECK_EQUAL(Serial.write('I'), 1);
+  CHECK_EQUAL(UDR0, 'A');
+  CHECK_EQUAL(Serial.availableForWrite(), 0);
+  for (uint8_t i = 1; i < 9; i++) CHECK_EQUAL(transmit(), 'A' + i);
+  CHECK_EQUAL(transmit(), -1);
+  CHECK_EQUAL(Serial.availableForWrite(), 8);
+
+  // flush() returns once the last byte is out
+  UCSR0A |= _BV(TXC0);
+  Serial.flush();
+  SREG |= _BV(SREG_I);
+
+  // received bytes come out of read() in order; 51 rounds of 5 leave
+  // the indices at 255, so the buffer fills across their wrap below
+  CHECK_EQUAL(Serial.available(), 0);
+  CHECK_EQUAL(Serial.read(), -1);
+  CHECK_EQUAL(Serial.peek(), -1);
+  for (int round = 0; round < 51; round++)
+  {
+    for (uint8_t i = 0; i < 5; i++) receive('a' + i);
+    CHECK_EQUAL(Serial.available(), 5);
+    CHECK_EQUAL(Serial.peek(), 'a');
+    for (uint8_t i = 0; i < 5; i++) CHECK_EQUAL(Serial.read(), 'a' + i);
+    CHECK_EQUAL(Serial.read(), -1);
+  }
+
+  // a full buffer drops and counts further bytes; DOR is counted too
+  for (uint8_t i = 0; i < 10; i++) receive('0' + i, i == 3 ? _BV(DOR0) : 0);
+  CHECK_EQUAL(Serial.available(), 8);
+  CHECK_EQUAL(Serial.rxBufferOverflows(), 2);
+  CHECK_EQUAL(Serial.rxOverruns(), 1);
+  for (uint8_t i = 0; i < 8; i++) CHECK_EQUAL(Serial.read(), '0' + i);
+
+  // code written for any Stream reaches the same port
+  Stream &stream = Serial;
+  receive('s');
+  CHECK_EQUAL(stream.available(), 1);
+  CHECK_EQUAL(stream.read(), 's');
+  CHECK_EQUAL(stream.available(), 0);
+  CHECK_EQUAL(stream.read(), -1);
+  udrEmpty();
+  stream.write('u');
+  stream.write('v');
+  CHECK_EQUAL(UDR0, 'u');
+  CHECK_EQUAL(Serial.availableForWrite(), 7);
+  // with interrupts off, flush() sends the buffered byte itself
+  SREG &= ~_BV(SREG_I);
+  udrEmpty();
+  stream.flush();
+  SREG |= _BV(SREG_I);
+  CHECK_EQUAL(UDR0, 'v');
+  CHECK_EQUAL(Serial.availableForWrite(), 8);
+
+  // begin() empties the buffer and clears the counts
+  receive('x');
+  Serial.begin(115200);
+  CHECK_EQUAL(Serial.available(), 0);
+  CHECK_EQUAL(Serial.rxBufferOverflows(), 0);
+
+  return TEST_RESULT();
+}
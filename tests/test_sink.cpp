@@ -0,0 +1,140 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the Print sink: output reaches a sink function in
+|| | whole runs, a String sum a part at a time, and PrintBuffer keeps
+|| | what fits and reports the rest.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+// a sink that records what it is given, taking at most limit bytes
+class Recorder : public Print
+{
+  public:
+    Recorder() : Print(&_sink) { clear(); }
+
+    void clear()
+    {
+      length = 0;
+      calls = 0;
+      limit = sizeof(text) - 1;
+      text[0] = 0;
+    }
+
+    char text[64];
+    size_t length;
+    uint8_t calls;
+    size_t limit;
+
+  private:
+    static size_t _sink(Print &p, const uint8_t *buffer, size_t size)
+    {
+      Recorder &r = static_cast<Recorder &>(p);
+      r.calls++;
+      if (size > r.limit - r.length) size = r.limit - r.length;
+      memcpy(r.text + r.length, buffer, size);
+      r.length += size;
+      r.text[r.length] = 0;
+      return size;
+    }
+};
+
+int main()
+{
+  Recorder r;
+
+  // text and numbers each reach the sink in one call
+  CHECK_EQUAL(r.print("hello"), 5);
+  CHECK_EQUAL(r.calls, 1);
+  CHECK_EQUAL(r.print(-12345), 6);
+  CHECK_EQUAL(r.print(0xBEEF, HEX), 4);
+  CHECK_EQUAL(r.print(String("str")), 3);
+  CHECK_EQUAL(r.print(Constant("flash")), 5);
+  CHECK_EQUAL(r.calls, 5);
+  CHECK_TEXT(r.text, "hello-12345BEEFstrflash");
+
+  // a base or number of places of any integer type; a char or bool
+  // second argument prints after the first
+  r.clear();
+  uint8_t base = HEX;
+  CHECK_EQUAL(r.print(255, base), 2);
+  r.print(' ');
+  r.print(255u, (unsigned)OCT);
+  r.print(' ');
+  r.print((uint8_t)5, (long)BIN);
+  r.print(' ');
+  r.print(3.14159, (uint8_t)3);
+  r.print(' ');
+  r.print(Fixed8_8::fromFloat(-1.5), (uint8_t)1);
+  r.print(' ');
+  r.print(7, ',');
+  bool flag = 1;
+  r.println(7, flag);
+  CHECK_TEXT(r.text, "FF 377 101 3.142 -1.5 7,71\r\n");
+
+  // the modifiers, alone and among other arguments
+  r.clear();
+  CHECK_EQUAL(r.print(hex(0xBEEFu)), 4);
+  r.print(' ', oct(8), ' ', bin((uint8_t)5), ' ', hex((int8_t)-1));
+  r.println(' ', fixed(2.5, 3), ' ', fixed(Fixed16_16(3), 0));
+  CHECK_TEXT(r.text, "BEEF 10 101 FFFFFFFF 2.500 3\r\n");
+
+  // a String sum prints a part at a time
+  r.clear();
+  int x = -42;
+  CHECK_EQUAL(r.print("a" + String(1) + 'c'), 3);
+  r.println(' ', "Value: " + String(x) + ", " + 2.5 + String());
+  CHECK_TEXT(r.text, "a1c Value: -42, 2.50\r\n");
+
+  // a single byte
+  r.clear();
+  CHECK_EQUAL(r.write('x'), 1);
+  CHECK_EQUAL(r.print('y'), 1);
+  CHECK_EQUAL(r.println(), 2);
+  CHECK_TEXT(r.text, "xy\r\n");
+
+  // what the sink didn't take is not counted
+  r.clear();
+  r.limit = 4;
+  CHECK_EQUAL(r.print("abcdef"), 4);
+  CHECK_EQUAL(r.print(123), 0);
+  CHECK_TEXT(r.text, "abcd");
+
+  // flash text longer than the copy chunk is streamed in chunks
+  r.clear();
+  CHECK_EQUAL(r.print(Constant("0123456789abcdefghijklmnopqrstuvwxyz")), 36);
+  CHECK_TEXT(r.text, "0123456789abcdefghijklmnopqrstuvwxyz");
+
+  PrintBuffer<8> buf;
+  CHECK_EQUAL(buf.capacity(), 8);
+  CHECK_EQUAL(buf.length(), 0);
+  CHECK_TEXT(buf.c_str(), "");
+  CHECK_EQUAL(buf.print("T="), 2);
+  CHECK_EQUAL(buf.print(21.5), 5);
+  CHECK_TEXT(buf.c_str(), "T=21.50");
+  CHECK(!buf.truncated());
+
+  // the rest is dropped, and stays reported until clear()
+  CHECK_EQUAL(buf.print("xyz"), 1);
+  CHECK_TEXT(buf.c_str(), "T=21.50x");
+  CHECK(buf.truncated());
+  CHECK_EQUAL(buf.print("z"), 0);
+  CHECK(buf.truncated());
+  buf.clear();
+  CHECK(!buf.truncated());
+  CHECK_TEXT(buf.c_str(), "");
+  CHECK_EQUAL(buf.print(12345678), 8);
+  CHECK(!buf.truncated());
+  CHECK_TEXT(buf.c_str(), "12345678");
+
+  return TEST_RESULT();
+}
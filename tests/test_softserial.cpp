@@ -0,0 +1,159 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the SoftSerial bit timing (_SoftSerialBaud) at the
+|| | F_CPU of the build.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+// built with -DSTUB_NO_USART, so Serial is the SoftSerial
+#include "Wiring.h"
+#include "test.h"
+
+typedef _SoftSerialBaud Baud;
+
+// cycles one bit takes with the loop count for cyclesPerBit
+static uint32_t bitCycles(uint32_t cyclesPerBit)
+{
+  return 4UL * Baud::loops(cyclesPerBit) + Baud::BIT_OVERHEAD;
+}
+
+static const uint32_t rates[] =
+  { 300, 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200 };
+
+static_assert(Baud::error(9600) <= SERIAL_BAUD_ERROR_MAX, "9600 baud");
+static_assert(Baud::error(F_CPU / 4) > SERIAL_BAUD_ERROR_MAX, "F_CPU / 4");
+
+// A frame played on RX as the delay loops count cycles: the start
+// bit, 8 data bits LSB first and the stop bit, each bitCycles long,
+// starting when delayCycles is 0.  The line idles at idleLevel after.
+static uint16_t frame;
+static uint32_t frameBitCycles;
+static bool idleLevel;
+
+static void playFrame()
+{
+  uint32_t bit = delayCycles / frameBitCycles;
+  bool level = bit < 10 ? (frame >> bit) & 1 : idleLevel;
+  if (level) PIND |= _BV(RX0);
+  else PIND &= ~_BV(RX0);
+}
+
+// reads one frame of data and stop bit; -1 if read() gave up
+static int receive(uint8_t data, bool stop, bool idle = true)
+{
+  frame = (uint16_t)data << 1 | (uint16_t)stop << 9;
+  idleLevel = idle;
+  delayCycles = 0;
+  PIND &= ~_BV(RX0);            // the start bit is arriving
+  return Serial.read();
+}
+
+// what write() puts on TX, sampled at the end of each delay
+static uint16_t sent;
+static uint8_t sentBits;
+
+static void recordTx()
+{
+  if (sentBits < 16 && (PORTD & _BV(TX0))) sent |= 1 << sentBits;
+  sentBits++;
+}
+
+int main()
+{
+  // within 2 cycles, rounded, wherever the loop count fits
+  for (uint32_t cycles = Baud::BIT_OVERHEAD + 2;
+       cycles < Baud::BIT_OVERHEAD + 4 * 0xFFFFUL; cycles++)
+  {
+    uint32_t got = bitCycles(cycles);
+    CHECK(got + 2 >= cycles && got <= cycles + 2);
+  }
+
+  // at least one loop: a count of 0 would be 65536
+  CHECK_EQUAL(Baud::loops(0), 1);
+  CHECK_EQUAL(Baud::loops(Baud::BIT_OVERHEAD), 1);
+  CHECK_EQUAL(Baud::loops(Baud::BIT_OVERHEAD + 2), 1);
+
+  // too slow for _delay_loop_2 stays at its longest count
+  CHECK_EQUAL(Baud::loops(Baud::BIT_OVERHEAD + 4 * 0xFFFFUL), 0xFFFF);
+  CHECK_EQUAL(Baud::loops(F_CPU), 0xFFFF);
+  CHECK_EQUAL(Baud::loops(0xFFFFFFFF), 0xFFFF);
+
+  // more than 16 bits of cycles, e.g. 200 baud at 16 MHz
+  CHECK_EQUAL(bitCycles(80000), 80000);
+
+  for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+  {
+    uint32_t cycles = F_CPU / rates[i];
+    CHECK(bitCycles(cycles) + 2 >= cycles && bitCycles(cycles) <= cycles + 2);
+    CHECK(Baud::error(rates[i]) <= SERIAL_BAUD_ERROR_MAX);
+  }
+
+  CHECK_EQUAL(Baud::error(F_CPU / 1000), 0);
+  CHECK_EQUAL(Baud::error(F_CPU / 8), 500);
+
+  Serial.begin(9600);
+  CHECK(!(DDRD & _BV(RX0)) && (PORTD & _BV(RX0)));
+  CHECK((DDRD & _BV(TX0)) && (PORTD & _BV(TX0)));
+  frameBitCycles = 4UL * Baud::loops(F_CPU / 9600);
+  delayHook = playFrame;
+
+  // an idle line has nothing to read and doesn't wait
+  PIND |= _BV(RX0);
+  delayCycles = 0;
+  CHECK_EQUAL(Serial.read(), -1);
+  CHECK_EQUAL(delayCycles, 0);
+
+  // each bit is sampled in its middle, with interrupts off meanwhile
+  static const uint8_t bytes[] = { 0x00, 0xFF, 0xA5, 0x5A, 0x01, 0x80, 'U' };
+  for (uint8_t i = 0; i < sizeof(bytes); i++)
+  {
+    SREG = _BV(SREG_I);
+    CHECK_EQUAL(receive(bytes[i], true), bytes[i]);
+    CHECK_EQUAL(SREG, _BV(SREG_I));
+  }
+
+  // a low stop bit is a framing error; read() gives up after the
+  // frame rather than waiting with interrupts off for the line to rise
+  SREG = _BV(SREG_I);
+  CHECK_EQUAL(receive(0x55, false), -1);
+  CHECK_EQUAL(SREG, _BV(SREG_I));
+
+  // an RX line stuck low (a break, or nothing connected) reads as -1
+  // each time, within one frame
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    CHECK_EQUAL(receive(0, false, false), -1);
+    CHECK(delayCycles <= 10 * frameBitCycles);
+    CHECK_EQUAL(SREG, _BV(SREG_I));
+  }
+
+  // code written for any Stream reaches the same pins
+  Stream &stream = Serial;
+  frame = 'S' << 1 | 1 << 9;
+  idleLevel = true;
+  delayCycles = 0;
+  PIND &= ~_BV(RX0);
+  CHECK_EQUAL(stream.available(), 1);
+  CHECK_EQUAL(stream.read(), 'S');
+  CHECK_EQUAL(stream.available(), 0);
+  stream.flush();
+
+  // write() sends start, data LSB first and stop, a bit per delay
+  delayHook = recordTx;
+  sent = sentBits = 0;
+  SREG = _BV(SREG_I);
+  CHECK_EQUAL(Serial.write(0xA5), 1);
+  CHECK_EQUAL(sentBits, 10);
+  CHECK_EQUAL(sent, 0xA5 << 1 | 1 << 9);
+  CHECK_EQUAL(SREG, _BV(SREG_I));
+  delayHook = 0;
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,293 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of the String buffer policy: short strings stay in the
+|| | inline buffer, concatenation grows the heap buffer with bounded
+|| | slack, and reserve() and shrink_to_fit() size it exactly; moves
+|| | and swap() hand buffers over without touching the heap; a
+|| | StaticString stays within its storage and reports what it cut.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include "Wiring.h"
+#include "test.h"
+
+// a String whose buffer can be inspected
+class Probe : public String
+{
+  public:
+    Probe(const char *cstr = "") : String(cstr) {}
+    unsigned int room() const { return capacity(); }
+    bool onHeap() const { return flags & STRING_HEAP; }
+    bool isInline() const { return flags & STRING_INLINE; }
+};
+
+// what a String held before it kept short strings inline
+struct PlainString
+{
+  char *buffer;
+  unsigned int capacity;
+  unsigned int len;
+  unsigned char flags;
+};
+
+static const char *longText = "a string too long to be kept inline";
+static const char *otherText = "another string that has to be on the heap";
+
+// true if s keeps its characters in the object
+static bool inside(const String &s)
+{
+  return s.c_str() >= (const char *)&s && s.c_str() < (const char *)(&s + 1);
+}
+
+static void clearHeapCounts()
+{
+  heapMallocs = heapReallocs = heapFrees = 0;
+}
+
+static unsigned long heapCalls()
+{
+  return heapMallocs + heapReallocs + heapFrees;
+}
+
+// a StaticString with room for 8 characters, and bytes after it
+// that writing past its storage would reach
+struct Guarded
+{
+  StaticString<8> s;
+  char guard[16];
+};
+
+// the capacity concat() gives a string that needs to reach length
+static unsigned int grown(unsigned int length, bool heap)
+{
+  if (!heap && length <= STRING_INLINE_CAPACITY) return STRING_INLINE_CAPACITY;
+  unsigned int slack = length / 2;
+  return length + (slack > STRING_GROWTH_MAX ? STRING_GROWTH_MAX : slack);
+}
+
+int main()
+{
+  // the inline characters share the heap pointer's and capacity's
+  // bytes, so at the default capacity a String is no bigger for them
+  if (STRING_INLINE_CAPACITY <= sizeof(char *) + sizeof(unsigned int) - 1)
+    CHECK_EQUAL(sizeof(String), sizeof(PlainString));
+
+  // short strings never touch the heap
+  Probe s;
+  CHECK(s.isInline());
+  CHECK_EQUAL(s.room(), STRING_INLINE_CAPACITY);
+  char digits[] = "12345678901234567890";
+  digits[STRING_INLINE_CAPACITY] = 0;
+  s = digits;
+  CHECK(s.isInline());
+  CHECK_EQUAL(s.room(), STRING_INLINE_CAPACITY);
+  CHECK_TEXT(s.c_str(), digits);
+  Probe number;
+  number += -2147483647L - 1;
+  CHECK_TEXT(number.c_str(), "-2147483648");
+  CHECK_EQUAL(number.isInline(), STRING_INLINE_CAPACITY >= 11);
+
+  // assignment sizes the buffer exactly
+  digits[STRING_INLINE_CAPACITY] = '1';
+  digits[STRING_INLINE_CAPACITY + 1] = 0;
+  s = digits;
+  CHECK(s.onHeap());
+  CHECK_EQUAL(s.room(), STRING_INLINE_CAPACITY + 1);
+  CHECK_TEXT(s.c_str(), digits);
+
+  // appending a character at a time grows by half again, up to
+  // STRING_GROWTH_MAX, and reallocates only when the slack runs out
+  static const unsigned int lengths[] = { 10, 100, 1000 };
+  for (unsigned int n : lengths)
+  {
+    Probe t;
+    unsigned int capacity = t.room(), changes = 0;
+    for (unsigned int i = 1; i <= n; i++)
+    {
+      t += (char)('a' + i % 26);
+      CHECK_EQUAL(t.length(), i);
+      if (t.room() != capacity)
+      {
+        CHECK(t.room() >= i);
+        CHECK_EQUAL(t.room(), grown(i, capacity > STRING_INLINE_CAPACITY));
+        capacity = t.room();
+        changes++;
+      }
+    }
+    CHECK(changes <= n / STRING_GROWTH_MAX + 8);
+    for (unsigned int i = 1; i <= n; i++)
+      CHECK_EQUAL(t[i - 1], 'a' + i % 26);
+  }
+
+  // a large append gets slack capped at STRING_GROWTH_MAX
+  Probe big;
+  big += "0123456789012345678901234567890123456789";
+  CHECK_EQUAL(big.room(), grown(40, false));
+  char chunk[201];
+  memset(chunk, 'z', 200);
+  chunk[200] = 0;
+  big += chunk;
+  CHECK_EQUAL(big.room(), 240 + STRING_GROWTH_MAX);
+
+  // reserve() makes room up front and appends then stay within it
+  Probe reserved;
+  CHECK(reserved.reserve(100));
+  CHECK_EQUAL(reserved.room(), 100);
+  for (int i = 0; i < 100; i++) reserved += 'r';
+  CHECK_EQUAL(reserved.room(), 100);
+  CHECK(reserved.reserve(50));
+  CHECK_EQUAL(reserved.room(), 100);
+
+  // shrink_to_fit() returns the slack, and a short string to inline
+  big.shrink_to_fit();
+  CHECK_EQUAL(big.room(), 240);
+  CHECK_EQUAL(big.length(), 240);
+  CHECK_EQUAL(big[239], 'z');
+  big.remove(3);
+  big.shrink_to_fit();
+  CHECK(big.isInline());
+  CHECK(!big.onHeap());
+  CHECK_TEXT(big.c_str(), "012");
+
+  // s += s when the buffer has to move
+  Probe self("abcdefghij");
+  self += self;
+  self += self;
+  CHECK_TEXT(self.c_str(), "abcdefghijabcdefghijabcdefghijabcdefghij");
+
+  // a copy allocates, so the counts see what String does
+  String heap(longText);
+  clearHeapCounts();
+  String copied(heap);
+  CHECK_EQUAL(heapMallocs, 1);
+
+  // move construction takes the heap buffer and leaves the source
+  // empty, not invalid, without a heap call
+  const char *p = heap.c_str();
+  clearHeapCounts();
+  String moved(static_cast<String &&>(heap));
+  CHECK(moved.c_str() == p);
+  CHECK_TEXT(moved.c_str(), longText);
+  CHECK(heap);
+  CHECK_TEXT(heap.c_str(), "");
+  CHECK_EQUAL(heap.length(), 0);
+  CHECK_EQUAL(heapCalls(), 0);
+
+  // move assignment frees only the buffer it replaces
+  String target(otherText);
+  clearHeapCounts();
+  target = static_cast<String &&>(moved);
+  CHECK(target.c_str() == p);
+  CHECK_TEXT(moved.c_str(), "");
+  CHECK_EQUAL(heapFrees, 1);
+  CHECK_EQUAL(heapCalls(), 1);
+
+  // inline characters are copied, into an inline or heap target
+  String small("ab");
+  String fromSmall(static_cast<String &&>(small));
+  CHECK_TEXT(fromSmall.c_str(), "ab");
+  CHECK(inside(fromSmall));
+  CHECK_TEXT(small.c_str(), "");
+  clearHeapCounts();
+  small = "xy";
+  target = static_cast<String &&>(small);
+  CHECK_TEXT(target.c_str(), "xy");
+  CHECK(inside(target));
+  CHECK_EQUAL(heapMallocs + heapReallocs, 0);
+  CHECK_EQUAL(heapFrees, 1);
+
+  // swap() of heap and heap, heap and inline, and inline and inline
+  // strings trades characters without a heap call
+  String one(longText), two(otherText), three("x"), four("yz");
+  const char *p1 = one.c_str(), *p2 = two.c_str();
+  clearHeapCounts();
+  one.swap(two);
+  CHECK(one.c_str() == p2);
+  CHECK(two.c_str() == p1);
+  one.swap(three);
+  CHECK_TEXT(one.c_str(), "x");
+  CHECK(inside(one));
+  CHECK(three.c_str() == p2);
+  three.swap(four);
+  CHECK_TEXT(three.c_str(), "yz");
+  CHECK(inside(three));
+  CHECK(four.c_str() == p2);
+  one.swap(three);
+  CHECK_TEXT(one.c_str(), "yz");
+  CHECK_TEXT(three.c_str(), "x");
+  one.swap(one);
+  CHECK_TEXT(one.c_str(), "yz");
+  CHECK_TEXT(four.c_str(), otherText);
+  CHECK_EQUAL(heapCalls(), 0);
+
+  // a StaticString's characters are in its own storage, and it
+  // carries no inline buffer besides
+  Guarded g;
+  memset(g.guard, '#', sizeof(g.guard));
+  StaticString<8> &f = g.s;
+  CHECK(sizeof(f) < sizeof(String) + 9 + alignof(String));
+  CHECK(f.c_str() > (const char *)&f);
+  CHECK(f.c_str() + 9 <= (const char *)&f + sizeof(f));
+
+  // += and concat() keep what fits, return false and set truncated()
+  // until clearTruncated()
+  f += "abcdef";
+  CHECK(!f.truncated());
+  f += "ghij";
+  CHECK_TEXT(f, "abcdefgh");
+  CHECK_EQUAL(f.length(), 8);
+  CHECK(f.truncated());
+  CHECK(!f.concat('x'));
+  CHECK_TEXT(f, "abcdefgh");
+  f.clearTruncated();
+  CHECK(!f.truncated());
+  f = "abc";
+  CHECK(f.concat(12345));
+  CHECK_TEXT(f, "abc12345");
+  CHECK(!f.truncated());
+  CHECK(!f.concat(6));
+  CHECK(f.truncated());
+  f.clearTruncated();
+
+  // so do assignment and a sum
+  f = "0123456789";
+  CHECK_TEXT(f, "01234567");
+  CHECK(f.truncated());
+  f.clearTruncated();
+  f = String("x") + "yyyyyyyyyy" + 1;
+  CHECK_TEXT(f, "xyyyyyyy");
+  CHECK(f.truncated());
+  f.clearTruncated();
+  f = (const char *)NULL;
+  CHECK(f);
+  CHECK_TEXT(f, "");
+
+  // replace() within the storage works in place; one that would
+  // overflow it leaves the string as it was and sets truncated()
+  f = "a-b-c";
+  f.replace("-", "--");
+  CHECK_TEXT(f, "a--b--c");
+  CHECK(!f.truncated());
+  f.replace("-", "===");
+  CHECK_TEXT(f, "a--b--c");
+  CHECK_EQUAL(f.length(), 7);
+  CHECK(f.truncated());
+  f.clearTruncated();
+  f.replace("--", "");
+  CHECK_TEXT(f, "abc");
+  f = "abcdefgh";
+  f.replace("h", "hi");
+  CHECK_TEXT(f, "abcdefgh");
+  CHECK(f.truncated());
+  for (unsigned int i = 0; i < sizeof(g.guard); i++)
+    CHECK_EQUAL(g.guard[i], '#');
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+/*
+||
+|| @author         Ralph Doncaster ralphdoncaster at gmail
+|| @url            http://wiring.org.co/
+||
+|| @description
+|| | Host test of millis() and micros() in WTime.cpp: the 48-bit
+|| | overflow count and TCNT0 are set around the points where the
+|| | count or the result wraps, and around a pending Timer0 overflow,
+|| | and the results checked against 128-bit arithmetic, at the F_CPU
+|| | of the build.
+|| #
+||
+|| @license Please see cores/Common/License.txt.
+||
+*/
+
+#include <math.h>
+#include "Wiring.h"
+#include "test.h"
+
+// as in WTime.cpp
+struct _Timer0Count
+{
+  uint32_t low;
+  uint16_t high;
+};
+extern volatile _Timer0Count timer0Overflows;
+extern "C" void TIMER0_OVF_vect(void);
+
+static const uint64_t usPerTickQ16 =
+  ((uint64_t)TIMER0PRESCALEFACTOR * 1000000 * 65536 + F_CPU / 2) / F_CPU;
+static const uint64_t msPerOvfQ16 =
+  ((uint64_t)TIMER0PRESCALEFACTOR * 256 * 1000 * 65536 + F_CPU / 2) / F_CPU;
+
+static const uint64_t COUNT_MASK = (1ULL << 48) - 1;
+
+static void setTimer0(uint64_t ovf, uint8_t t, bool pending = false)
+{
+  timer0Overflows.low = ovf;
+  timer0Overflows.high = ovf >> 32;
+  TCNT0 = t;
+  TIFR0 = pending ? _BV(TOV0) : 0;
+}
+
+static uint32_t wantMillis(uint64_t ovf)
+{
+  return ((unsigned __int128)(ovf & COUNT_MASK) * msPerOvfQ16) >> 16;
+}
+
+static uint32_t wantMicros(uint64_t ovf, uint8_t t)
+{
+  uint64_t ticks = (ovf & COUNT_MASK) << 8 | t;
+  return ((unsigned __int128)ticks * usPerTickQ16) >> 16;
+}
+
+// one step of a Q16 rate is its whole part, or one more if it has a
+// fraction
+static bool isStep(uint32_t step, uint64_t q16)
+{
+  return step == (q16 >> 16) || ((q16 & 0xFFFF) && step == (q16 >> 16) + 1);
+}
+
+// every overflow count in [first, first + n), against the reference
+// and against the one before it, so a wrap anywhere shows as a step
+static void checkOverflows(uint64_t first, uint32_t n)
+{
+  uint32_t ms = 0, us = 0;
+  for (uint64_t ovf = first; ovf != first + n; ovf++)
+  {
+    setTimer0(ovf, 0);
+    uint32_t gotMs = millis();
+    CHECK_EQUAL(gotMs, wantMillis(ovf));
+    if (ovf != first) CHECK(isStep(gotMs - ms, msPerOvfQ16));
+    ms = gotMs;
+
+    for (uint16_t t = 0; t < 256; t++)
+    {
+      setTimer0(ovf, t);
+      uint32_t gotUs = micros();
+      CHECK_EQUAL(gotUs, wantMicros(ovf, t));
+      if (ovf != first || t) CHECK(isStep(gotUs - us, usPerTickQ16));
+      us = gotUs;
+    }
+  }
+}
+
+int main()
+{
+  SREG = 0;
+
+  // from reset; the first count where millis() and micros() pass 2^32;
+  // the count's low 32 bits wrapping; the count itself wrapping
+  uint64_t msWrap = ((1ULL << 48) + msPerOvfQ16 - 1) / msPerOvfQ16;
+  uint64_t usWrap = (((1ULL << 48) + usPerTickQ16 - 1) / usPerTickQ16) >> 8;
+  checkOverflows(0, 64);
+  checkOverflows(msWrap - 32, 64);
+  checkOverflows(usWrap - 32, 64);
+  checkOverflows((1ULL << 32) - 32, 64);
+  checkOverflows((1ULL << 48) - 32, 64);
+  CHECK(wantMillis(msWrap - 1) > wantMillis(msWrap));
+  CHECK(wantMicros(usWrap, 255) < wantMicros(usWrap - 1, 255));
+
+  // a day in, the real time within the rounding of the constants
+  uint64_t ovf = 86400ULL * F_CPU / TIMER0PRESCALEFACTOR / 256;
+  setTimer0(ovf, 0);
+  double ms = (double)ovf * TIMER0PRESCALEFACTOR * 256 * 1000 / F_CPU;
+  CHECK(fabs(millis() - ms) <= 1 + ms * 6e-6);
+  CHECK(fabs(micros() - fmod(ms * 1000, 4294967296.0)) <= 1 + ms * 6e-3);
+
+  // an overflow pending with interrupts off counts once TCNT0 has
+  // wrapped, and not while it still reads 255
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    static const uint64_t counts[] =
+      { 1000, (1ULL << 32) - 1, msWrap - 1, (1ULL << 48) - 1 };
+    uint64_t n = counts[i];
+    setTimer0(n, 3, true);
+    CHECK_EQUAL(millis(), wantMillis(n + 1));
+    setTimer0(n, 3, true);
+    CHECK_EQUAL(micros(), wantMicros(n + 1, 3));
+    setTimer0(n, 255, true);
+    CHECK_EQUAL(millis(), wantMillis(n));
+    setTimer0(n, 255, true);
+    CHECK_EQUAL(micros(), wantMicros(n, 255));
+
+    // the same times once the handler has run
+    setTimer0(n, 255);
+    uint32_t before = micros();
+    TIMER0_OVF_vect();
+    TCNT0 = 0;
+    CHECK(isStep(micros() - before, usPerTickQ16));
+    CHECK_EQUAL((uint64_t)timer0Overflows.high << 32 | timer0Overflows.low,
+                (n + 1) & COUNT_MASK);
+  }
+
+  // the snapshot leaves the interrupt flag as it was
+  setTimer0(0, 0);
+  SREG = _BV(SREG_I);
+  millis();
+  micros();
+  CHECK_EQUAL(SREG, _BV(SREG_I));
+  SREG = 0;
+  micros();
+  CHECK_EQUAL(SREG, 0);
+
+  return TEST_RESULT();
+}
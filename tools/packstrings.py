@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Pack flash strings for PackedString (WPackedString.h).
+
+usage: packstrings.py strings.txt name
+
+strings.txt has one string per line, an identifier and a C string
+literal, with # comments and blank lines ignored:
+
+    help_set    "set <name> <value>  change a setting\\r\\n"
+    err_range   "value out of range\\r\\n"
+
+Writes name.h and name.cpp.  Include name.h wherever the strings are
+used and add name.cpp to the build once; then Serial.print(help_set)
+prints the first string.
+
+Bytes 0x01-0x7F of a packed string are literal characters and bytes
+0x80-0xFF are one of up to 128 dictionary entries of plain text, so
+the decoder never recurses.  The dictionary is built greedily, each
+round adding the substring that saves the most flash.
+"""
+
+import re
+import sys
+
+MAX_ENTRIES = 128
+MAX_ENTRY_LENGTH = 32
+INDEX_COST = 2          # uint16_t offset per dictionary entry
+
+LINE = re.compile(r'^\s*([A-Za-z_]\w*)\s+"((?:[^"\\]|\\.)*)"\s*$')
+ESCAPES = {'n': '\n', 'r': '\r', 't': '\t', '\\': '\\', '"': '"',
+           "'": "'", '0': '\0', 'a': '\a', 'b': '\b', 'f': '\f', 'v': '\v'}
+
+
+def unescape(s, where):
+    out = []
+    i = 0
+    while i < len(s):
+        c = s[i]
+        if c == '\\':
+            i += 1
+            e = s[i]
+            if e == 'x':
+                m = re.match(r'[0-9A-Fa-f]{1,2}', s[i + 1:])
+                if not m:
+                    sys.exit('%s: \\x without hex digits in "%s"' % (where, s))
+                out.append(chr(int(m.group(0), 16)))
+                i += len(m.group(0))
+            elif e in ESCAPES:
+                out.append(ESCAPES[e])
+            else:
+                sys.exit('%s: unknown escape \\%s' % (where, e))
+        else:
+            out.append(c)
+        i += 1
+    text = ''.join(out)
+    if any(not 0 < ord(ch) < 0x80 for ch in text):
+        sys.exit('%s: only ASCII 0x01-0x7F can be packed' % where)
+    return text.encode('ascii')
+
+
+def parse(path):
+    strings = []
+    names = set()
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            if not line.strip() or line.lstrip().startswith('#'):
+                continue
+            m = LINE.match(line)
+            where = '%s:%d' % (path, n)
+            if not m:
+                sys.exit('%s: expected identifier "string"' % where)
+            if m.group(1) in names:
+                sys.exit('%s: %s defined twice' % (where, m.group(1)))
+            names.add(m.group(1))
+            strings.append((m.group(1), unescape(m.group(2), where)))
+    return strings
+
+
+# A packed string during dictionary building is a list of runs: bytes
+# objects of still literal text, and ints for dictionary entries.
+
+def candidates(packed):
+    """Count the non-overlapping uses of each substring of literal text."""
+    counts = {}
+    last = {}
+    for si, runs in enumerate(packed):
+        for ri, run in enumerate(runs):
+            if isinstance(run, int):
+                continue
+            for i in range(len(run) - 1):
+                for j in range(i + 2, min(len(run), i + MAX_ENTRY_LENGTH) + 1):
+                    s = run[i:j]
+                    pos = (si, ri, i)
+                    prev = last.get(s)
+                    if prev and prev[:2] == pos[:2] and prev[2] + len(s) > i:
+                        continue
+                    last[s] = pos
+                    counts[s] = counts.get(s, 0) + 1
+    return counts
+
+
+def replace(packed, entry, code):
+    for runs in packed:
+        out = []
+        for run in runs:
+            if isinstance(run, int):
+                out.append(run)
+                continue
+            parts = run.split(entry)
+            for k, part in enumerate(parts):
+                if k:
+                    out.append(code)
+                if part:
+                    out.append(part)
+        runs[:] = out
+
+
+def build(strings):
+    packed = [[text] for _, text in strings]
+    dictionary = []
+    while len(dictionary) < MAX_ENTRIES:
+        best = None
+        best_saving = 0
+        for s, count in candidates(packed).items():
+            saving = count * (len(s) - 1) - len(s) - INDEX_COST
+            if saving > best_saving or (saving == best_saving and best
+                                        and len(s) > len(best)):
+                best = s
+                best_saving = saving
+        if best is None:
+            break
+        replace(packed, best, 0x80 + len(dictionary))
+        dictionary.append(best)
+
+    encoded = []
+    for runs in packed:
+        data = bytearray()
+        for run in runs:
+            if isinstance(run, int):
+                data.append(run)
+            else:
+                data += run
+        encoded.append(bytes(data))
+    return dictionary, encoded
+
+
+def bytes_c(data, indent='  '):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ', '.join('0x%02X' % b for b in data[i:i + 12]) + ',')
+    return '\n'.join(lines)
+
+
+def comment(text):
+    s = text.decode('ascii').encode('unicode_escape').decode('ascii')
+    if len(s) > 60:
+        s = s[:57] + '...'
+    # quoted, so a trailing backslash can't continue the comment line
+    return '"%s"' % s
+
+
+def write(name, strings, dictionary, encoded, source):
+    guard = re.sub(r'\W', '_', name).upper() + '_H'
+    prefix = re.sub(r'\W', '_', name)
+    header = ['// Generated by tools/packstrings.py from %s; do not edit.' % source,
+              '',
+              '#ifndef %s' % guard,
+              '#define %s' % guard,
+              '',
+              '#include <WPackedString.h>',
+              '',
+              'extern const uint8_t %s_dict[] PROGMEM;' % prefix,
+              'extern const uint16_t %s_index[] PROGMEM;' % prefix,
+              '']
+    for (ident, _), data in zip(strings, encoded):
+        header.append('extern const uint8_t %s_%s[] PROGMEM;' % (prefix, ident))
+    header.append('')
+    for ident, text in strings:
+        header.append('// %s' % comment(text))
+        header.append('#define %s PackedString(%s_dict, %s_index, %s_%s)'
+                      % (ident, prefix, prefix, prefix, ident))
+    header += ['', '#endif', '// %s' % guard, '']
+
+    offsets = [0]
+    for entry in dictionary:
+        offsets.append(offsets[-1] + len(entry))
+    cpp = ['// Generated by tools/packstrings.py from %s; do not edit.' % source,
+           '',
+           '#include "%s.h"' % name,
+           '',
+           'const uint8_t %s_dict[] PROGMEM = {' % prefix,
+           bytes_c(b''.join(dictionary) or b'\0'),
+           '};',
+           '',
+           'const uint16_t %s_index[] PROGMEM = {' % prefix]
+    for i in range(0, len(offsets), 8):
+        cpp.append('  ' + ', '.join(str(o) for o in offsets[i:i + 8]) + ',')
+    cpp += ['};', '']
+    for (ident, text), data in zip(strings, encoded):
+        cpp.append('// %s' % comment(text))
+        cpp.append('const uint8_t %s_%s[] PROGMEM = {' % (prefix, ident))
+        cpp.append(bytes_c(data + b'\0'))
+        cpp.append('};')
+        cpp.append('')
+
+    with open(name + '.h', 'w') as f:
+        f.write('\n'.join(header))
+    with open(name + '.cpp', 'w') as f:
+        f.write('\n'.join(cpp))
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().split('\n\n')[1])
+    source, name = sys.argv[1], sys.argv[2]
+    strings = parse(source)
+    dictionary, encoded = build(strings)
+    write(name, strings, dictionary, encoded, source)
+
+    plain = sum(len(text) + 1 for _, text in strings)
+    packed = (sum(len(data) + 1 for data in encoded) +
+              sum(len(e) for e in dictionary) + INDEX_COST * (len(dictionary) + 1))
+    print('%d strings, %d bytes as Constant(), %d packed (%d%%), '
+          '%d dictionary entries'
+          % (len(strings), plain, packed, 100 * packed // max(plain, 1),
+             len(dictionary)))
+
+
+if __name__ == '__main__':
+    main()